@@ -0,0 +1 @@
+/usr/bin/cc  -Wall -Wextra -O2 -include config.h -D__LINUX__=1 -L./ -o .demo-headless/demo-headless .demo-headless/apps/main.c.o  libapps.a libtwin.a   -ljpeg    -lpng16 -pthread  
@@ -0,0 +1 @@
+/usr/bin/cc  -Wall -Wextra -O2 -include config.h -D__LINUX__=1 -L./ -o .headless-ctl/headless-ctl .headless-ctl/tools/headless-ctl.c.o    
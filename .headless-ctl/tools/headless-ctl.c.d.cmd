@@ -0,0 +1 @@
+/usr/bin/cc -Wall -Wextra -O2 -include config.h -D__LINUX__=1   -Iinclude -M tools/headless-ctl.c | sed 's,\(headless-ctl\.o\) *:,.headless-ctl/tools/ .headless-ctl/tools/headless-ctl.c.d: ,' > .headless-ctl/tools/headless-ctl.c.d; cp -rf .headless-ctl/tools/headless-ctl.c.d .headless-ctl/tools/headless-ctl.c.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .headless-ctl/tools/headless-ctl.c.d >> .headless-ctl/tools/headless-ctl.c.d.p; mv .headless-ctl/tools/headless-ctl.c.d.p .headless-ctl/tools/headless-ctl.c.d
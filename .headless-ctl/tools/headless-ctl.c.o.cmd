@@ -0,0 +1 @@
+/usr/bin/cc  -Wall -Wextra -O2 -include config.h -D__LINUX__=1    -Iinclude -c -o .headless-ctl/tools/headless-ctl.c.o tools/headless-ctl.c
@@ -0,0 +1 @@
+/usr/bin/cc -Wall -Wextra -O2 -include config.h -D__LINUX__=1   -Iinclude -M apps/calc.c | sed 's,\(calc\.o\) *:,.libapps.a/apps/ .libapps.a/apps/calc.c.d: ,' > .libapps.a/apps/calc.c.d; cp -rf .libapps.a/apps/calc.c.d .libapps.a/apps/calc.c.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .libapps.a/apps/calc.c.d >> .libapps.a/apps/calc.c.d.p; mv .libapps.a/apps/calc.c.d.p .libapps.a/apps/calc.c.d
@@ -0,0 +1 @@
+/usr/bin/cc -Wall -Wextra -O2 -include config.h -D__LINUX__=1   -Iinclude -M apps/dummy.c | sed 's,\(dummy\.o\) *:,.libapps.a/apps/ .libapps.a/apps/dummy.c.d: ,' > .libapps.a/apps/dummy.c.d; cp -rf .libapps.a/apps/dummy.c.d .libapps.a/apps/dummy.c.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .libapps.a/apps/dummy.c.d >> .libapps.a/apps/dummy.c.d.p; mv .libapps.a/apps/dummy.c.d.p .libapps.a/apps/dummy.c.d
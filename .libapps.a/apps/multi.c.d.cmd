@@ -0,0 +1 @@
+/usr/bin/cc -Wall -Wextra -O2 -include config.h -D__LINUX__=1   -Iinclude -M apps/multi.c | sed 's,\(multi\.o\) *:,.libapps.a/apps/ .libapps.a/apps/multi.c.d: ,' > .libapps.a/apps/multi.c.d; cp -rf .libapps.a/apps/multi.c.d .libapps.a/apps/multi.c.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .libapps.a/apps/multi.c.d >> .libapps.a/apps/multi.c.d.p; mv .libapps.a/apps/multi.c.d.p .libapps.a/apps/multi.c.d
@@ -0,0 +1,2 @@
+ar rcs .libapps.a/libapps.a .libapps.a/apps/animation.c.o .libapps.a/apps/calc.c.o .libapps.a/apps/clock.c.o .libapps.a/apps/dummy.c.o .libapps.a/apps/image.c.o .libapps.a/apps/multi.c.o .libapps.a/apps/spline.c.o
+ranlib .libapps.a/libapps.a
@@ -0,0 +1 @@
+/usr/bin/cc -Wall -Wextra -O2 -include config.h -D__LINUX__=1 -I/usr/include/libpng16 -pthread  -Iinclude -Isrc -M backend/headless.c | sed 's,\(headless\.o\) *:,.libtwin.a/backend/ .libtwin.a/backend/headless.c.d: ,' > .libtwin.a/backend/headless.c.d; cp -rf .libtwin.a/backend/headless.c.d .libtwin.a/backend/headless.c.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .libtwin.a/backend/headless.c.d >> .libtwin.a/backend/headless.c.d.p; mv .libtwin.a/backend/headless.c.d.p .libtwin.a/backend/headless.c.d
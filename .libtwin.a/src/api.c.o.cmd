@@ -0,0 +1 @@
+/usr/bin/cc  -Wall -Wextra -O2 -include config.h -D__LINUX__=1  -I/usr/include/libpng16 -pthread  -Iinclude -Isrc -c -o .libtwin.a/src/api.c.o src/api.c
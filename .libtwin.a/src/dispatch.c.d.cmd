@@ -0,0 +1 @@
+/usr/bin/cc -Wall -Wextra -O2 -include config.h -D__LINUX__=1 -I/usr/include/libpng16 -pthread  -Iinclude -Isrc -M src/dispatch.c | sed 's,\(dispatch\.o\) *:,.libtwin.a/src/ .libtwin.a/src/dispatch.c.d: ,' > .libtwin.a/src/dispatch.c.d; cp -rf .libtwin.a/src/dispatch.c.d .libtwin.a/src/dispatch.c.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .libtwin.a/src/dispatch.c.d >> .libtwin.a/src/dispatch.c.d.p; mv .libtwin.a/src/dispatch.c.d.p .libtwin.a/src/dispatch.c.d
@@ -0,0 +1 @@
+/usr/bin/cc -Wall -Wextra -O2 -include config.h -D__LINUX__=1 -I/usr/include/libpng16 -pthread  -Iinclude -Isrc -M src/font_default.c | sed 's,\(font_default\.o\) *:,.libtwin.a/src/ .libtwin.a/src/font_default.c.d: ,' > .libtwin.a/src/font_default.c.d; cp -rf .libtwin.a/src/font_default.c.d .libtwin.a/src/font_default.c.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .libtwin.a/src/font_default.c.d >> .libtwin.a/src/font_default.c.d.p; mv .libtwin.a/src/font_default.c.d.p .libtwin.a/src/font_default.c.d
@@ -0,0 +1 @@
+/usr/bin/cc -Wall -Wextra -O2 -include config.h -D__LINUX__=1 -I/usr/include/libpng16 -pthread  -Iinclude -Isrc -M src/hull.c | sed 's,\(hull\.o\) *:,.libtwin.a/src/ .libtwin.a/src/hull.c.d: ,' > .libtwin.a/src/hull.c.d; cp -rf .libtwin.a/src/hull.c.d .libtwin.a/src/hull.c.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .libtwin.a/src/hull.c.d >> .libtwin.a/src/hull.c.d.p; mv .libtwin.a/src/hull.c.d.p .libtwin.a/src/hull.c.d
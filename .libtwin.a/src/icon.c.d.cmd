@@ -0,0 +1 @@
+/usr/bin/cc -Wall -Wextra -O2 -include config.h -D__LINUX__=1 -I/usr/include/libpng16 -pthread  -Iinclude -Isrc -M src/icon.c | sed 's,\(icon\.o\) *:,.libtwin.a/src/ .libtwin.a/src/icon.c.d: ,' > .libtwin.a/src/icon.c.d; cp -rf .libtwin.a/src/icon.c.d .libtwin.a/src/icon.c.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .libtwin.a/src/icon.c.d >> .libtwin.a/src/icon.c.d.p; mv .libtwin.a/src/icon.c.d.p .libtwin.a/src/icon.c.d
@@ -0,0 +1 @@
+/usr/bin/cc -Wall -Wextra -O2 -include config.h -D__LINUX__=1 -I/usr/include/libpng16 -pthread  -Iinclude -Isrc -M src/queue.c | sed 's,\(queue\.o\) *:,.libtwin.a/src/ .libtwin.a/src/queue.c.d: ,' > .libtwin.a/src/queue.c.d; cp -rf .libtwin.a/src/queue.c.d .libtwin.a/src/queue.c.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .libtwin.a/src/queue.c.d >> .libtwin.a/src/queue.c.d.p; mv .libtwin.a/src/queue.c.d.p .libtwin.a/src/queue.c.d
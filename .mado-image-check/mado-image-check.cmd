@@ -0,0 +1 @@
+/usr/bin/cc  -Wall -Wextra -O2 -include config.h -D__LINUX__=1 -L./ -o .mado-image-check/mado-image-check .mado-image-check/tools/image-check.c.o  libapps.a libtwin.a   -ljpeg    -lpng16 -pthread  
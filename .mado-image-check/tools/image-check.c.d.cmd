@@ -0,0 +1 @@
+/usr/bin/cc -Wall -Wextra -O2 -include config.h -D__LINUX__=1   -Iinclude -M tools/image-check.c | sed 's,\(image-check\.o\) *:,.mado-image-check/tools/ .mado-image-check/tools/image-check.c.d: ,' > .mado-image-check/tools/image-check.c.d; cp -rf .mado-image-check/tools/image-check.c.d .mado-image-check/tools/image-check.c.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .mado-image-check/tools/image-check.c.d >> .mado-image-check/tools/image-check.c.d.p; mv .mado-image-check/tools/image-check.c.d.p .mado-image-check/tools/image-check.c.d
@@ -0,0 +1 @@
+/usr/bin/cc  -Wall -Wextra -O2 -include config.h -D__LINUX__=1 -L./ -o .mado-perf/mado-perf .mado-perf/tools/perf.c.o  libapps.a libtwin.a   -ljpeg    -lpng16 -pthread  
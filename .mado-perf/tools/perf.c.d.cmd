@@ -0,0 +1 @@
+/usr/bin/cc -Wall -Wextra -O2 -include config.h -D__LINUX__=1   -Iinclude -M tools/perf.c | sed 's,\(perf\.o\) *:,.mado-perf/tools/ .mado-perf/tools/perf.c.d: ,' > .mado-perf/tools/perf.c.d; cp -rf .mado-perf/tools/perf.c.d .mado-perf/tools/perf.c.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .mado-perf/tools/perf.c.d >> .mado-perf/tools/perf.c.d.p; mv .mado-perf/tools/perf.c.d.p .mado-perf/tools/perf.c.d
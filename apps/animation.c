@@ -27,13 +27,10 @@ static void _apps_animation_paint(twin_custom_widget_t *custom)
         (apps_animation_data_t *) twin_custom_widget_data(custom);
     twin_pixmap_t *current_frame = NULL;
 
-    if (twin_pixmap_is_animated(anim->pix)) {
-        twin_animation_t *a = anim->pix->animation;
-        current_frame = twin_animation_get_current_frame(a);
-        twin_animation_advance_frame(a);
-    } else {
+    if (twin_pixmap_is_animated(anim->pix))
+        current_frame = twin_animation_get_current_frame(anim->pix->animation);
+    else
         current_frame = anim->pix;
-    }
 
     twin_operand_t srcop = {
         .source_kind = TWIN_PIXMAP,
@@ -43,14 +40,47 @@ static void _apps_animation_paint(twin_custom_widget_t *custom)
                    0, TWIN_SOURCE, current_frame->width, current_frame->height);
 }
 
+/* Copy the part of the new frame that changed straight into the window,
+ * rather than queueing a paint that would redraw the whole widget. */
+static void _apps_animation_update(twin_custom_widget_t *custom)
+{
+    apps_animation_data_t *anim =
+        (apps_animation_data_t *) twin_custom_widget_data(custom);
+    twin_animation_t *a = anim->pix->animation;
+    twin_rect_t damage = twin_animation_get_current_damage(a);
+    twin_widget_t *widget = twin_custom_widget_base(custom);
+    twin_pixmap_t *pixmap = _apps_animation_pixmap(custom);
+    twin_rect_t clip;
+    twin_coord_t ox, oy;
+
+    if (damage.left >= damage.right || damage.top >= damage.bottom)
+        return;
+
+    twin_operand_t srcop = {
+        .source_kind = TWIN_PIXMAP,
+        .u.pixmap = twin_animation_get_current_frame(a),
+    };
+    clip = twin_pixmap_save_clip(pixmap);
+    twin_pixmap_get_origin(pixmap, &ox, &oy);
+    twin_pixmap_set_clip(pixmap, widget->extents);
+    twin_pixmap_set_origin(pixmap, ox + widget->extents.left,
+                           oy + widget->extents.top);
+    twin_composite(pixmap, damage.left, damage.top, &srcop, damage.left,
+                   damage.top, NULL, 0, 0, TWIN_SOURCE,
+                   damage.right - damage.left, damage.bottom - damage.top);
+    twin_pixmap_restore_clip(pixmap, clip);
+    twin_pixmap_set_origin(pixmap, ox, oy);
+}
+
 static twin_time_t _apps_animation_timeout(twin_time_t now, void *closure)
 {
     (void) now; /* unused parameter */
     twin_custom_widget_t *custom = closure;
     apps_animation_data_t *anim =
         (apps_animation_data_t *) twin_custom_widget_data(custom);
-    twin_custom_widget_queue_paint(custom);
     twin_animation_t *a = anim->pix->animation;
+    twin_animation_advance_frame(a);
+    _apps_animation_update(custom);
     twin_time_t delay = twin_animation_get_current_delay(a);
     return delay;
 }
@@ -58,6 +58,7 @@ static twin_pixmap_t *load_background(twin_screen_t *screen, const char *path)
     twin_fixed_t sy = twin_fixed_div(twin_int_to_fixed(raw_background->height),
                                      twin_int_to_fixed(screen->height));
     twin_matrix_scale(&raw_background->transform, sx, sy);
+    twin_pixmap_set_filter(raw_background, TWIN_FILTER_BOX);
     twin_operand_t srcop = {
         .source_kind = TWIN_PIXMAP,
         .u.pixmap = raw_background,
@@ -389,6 +389,7 @@ static void apps_blur(twin_screen_t *screen, int x, int y, int w, int h)
                         twin_int_to_fixed(client_height));
 
     twin_matrix_scale(&raw_background->transform, sx, sy);
+    twin_pixmap_set_filter(raw_background, TWIN_FILTER_BOX);
     twin_operand_t srcop = {
         .source_kind = TWIN_PIXMAP,
         .u.pixmap = raw_background,
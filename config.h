@@ -0,0 +1,36 @@
+#define CONFIG_CONFIGURED 1
+#define CONFIG_BACKEND_HEADLESS 1
+#define CONFIG_RENDERER_BUILTIN 1
+#define CONFIG_LOGGING 1
+#define CONFIG_LOGGING_COLOR 1
+#define CONFIG_LOGGING_CALLBACK 1
+#define CONFIG_MEMORY_STATS 1
+#define CONFIG_WINDOW_MANAGER 1
+#define CONFIG_DROP_SHADOW 1
+#define CONFIG_HORIZONTAL_OFFSET 6
+#define CONFIG_VERTICAL_OFFSET 6
+#define CONFIG_SHADOW_BLUR 12
+#define CONFIG_SHADOW_FADE_TAIL 2
+#define CONFIG_LOADER_PNG 1
+#define CONFIG_LOADER_JPEG 1
+#define CONFIG_LOADER_GIF 1
+#define CONFIG_GIF_LOOKAHEAD 1
+#define CONFIG_GIF_KEYFRAME_INTERVAL 16
+#define CONFIG_LOADER_TVG 1
+#define CONFIG_TVG_MEMORY_BUDGET 0
+#define CONFIG_IMAGE_CACHE 1
+#define CONFIG_IMAGE_CACHE_SIZE 2048
+#define CONFIG_LOADER_ASYNC 1
+#define CONFIG_LOADER_ASYNC_THREADS 2
+#define CONFIG_DEMO_APPLICATIONS 1
+#define CONFIG_DEMO_MULTI 1
+#define CONFIG_DEMO_CLOCK 1
+#define CONFIG_DEMO_CALCULATOR 1
+#define CONFIG_DEMO_SPLINE 1
+#define CONFIG_DEMO_ANIMATION 1
+#define CONFIG_DEMO_IMAGE 1
+#define CONFIG_TOOLS 1
+#define CONFIG_PERF_TEST 1
+#define CONFIG_TOOL_HEADLESS_CTL 1
+#define CONFIG_TOOL_IMAGE_CHECK 1
+#define CONFIG_FONT_FILE 1
@@ -48,6 +48,19 @@ typedef enum {
 
 #define twin_bytes_per_pixel(format) (1 << (twin_coord_t) (format))
 
+/**
+ * Sampling filter used when a transformed pixmap is composited
+ *
+ * Bilinear is the default.  Nearest trades quality for speed in live
+ * previews; box averages every covered source pixel and only differs
+ * from bilinear for downscales beyond 2x, where 4 taps alias.
+ */
+typedef enum {
+    TWIN_FILTER_BILINEAR /**< 2x2 interpolation (default) */,
+    TWIN_FILTER_NEAREST /**< Closest source pixel */,
+    TWIN_FILTER_BOX /**< Area average for large downscales */
+} twin_filter_t;
+
 /*
  * Angles
  */
@@ -115,6 +128,7 @@ typedef struct _twin_window twin_window_t;
 typedef struct _twin_screen twin_screen_t;
 typedef struct _twin_pixmap twin_pixmap_t;
 typedef struct _twin_animation twin_animation_t;
+typedef struct _twin_animation_stream twin_animation_stream_t;
 
 /** Button signal types (used in unified event system) */
 typedef enum _twin_button_signal {
@@ -215,6 +229,7 @@ typedef struct _twin_animation_iter {
     twin_count_t current_index;   /**< Current frame index */
     twin_pixmap_t *current_frame; /**< Current frame pixmap */
     twin_time_t current_delay;    /**< Current frame delay time */
+    twin_rect_t current_damage;   /**< Area changed from the last frame */
 } twin_animation_iter_t;
 
 /**
@@ -224,12 +239,13 @@ typedef struct _twin_animation_iter {
  * timing, frame data, and playback state.
  */
 typedef struct _twin_animation {
-    twin_pixmap_t **frames;      /**< Array of frame pixmaps */
-    twin_count_t n_frames;       /**< Number of frames */
-    twin_time_t *frame_delays;   /**< Per-frame timing in milliseconds */
-    bool loop;                   /**< Loop animation flag */
-    twin_animation_iter_t *iter; /**< Playback iterator */
-    twin_coord_t width, height;  /**< Animation dimensions in pixels */
+    twin_pixmap_t **frames;          /**< Array of frame pixmaps, or NULL */
+    twin_count_t n_frames;           /**< Number of frames */
+    twin_time_t *frame_delays;       /**< Per-frame timing in milliseconds */
+    bool loop;                       /**< Loop animation flag */
+    twin_animation_iter_t *iter;     /**< Playback iterator */
+    twin_coord_t width, height;      /**< Animation dimensions in pixels */
+    twin_animation_stream_t *stream; /**< On-demand frame decoder, or NULL */
 } twin_animation_t;
 
 /**
@@ -252,6 +268,7 @@ typedef struct _twin_pixmap {
     twin_coord_t width, height; /**< Dimensions in pixels */
     twin_coord_t stride;        /**< Row stride in bytes */
     twin_matrix_t transform;    /**< 2D transformation matrix */
+    twin_filter_t filter;       /**< Sampling filter for the transform */
 
     /* Clipping and origin */
     twin_rect_t clip;                /**< Clipping rectangle */
@@ -261,13 +278,15 @@ typedef struct _twin_pixmap {
     twin_animation_t *animation; /**< Animation data if animated */
     twin_pointer_t p;            /**< Pixel data pointer */
 
-    bool shadow; /**< Drop shadow for active windows */
+    bool shadow;       /**< Drop shadow for active windows */
+    twin_a8_t opacity; /**< Layer opacity applied by the screen (0xff) */
 
     twin_window_t *window; /**< Associated window (if any) */
 
     /* Transform buffer cache for compositing operations */
     void *xform_cache;       /**< Cached xform buffer */
     size_t xform_cache_size; /**< Cached xform buffer size in bytes */
+    void *image_cache;       /**< Renderer image wrapper (Pixman) */
 } twin_pixmap_t;
 
 /**
@@ -340,7 +359,8 @@ struct _twin_screen {
     void *closure;              /**< Backend user data */
 
     /* Window manager */
-    twin_coord_t button_x, button_y; /**< Window button position */
+    twin_coord_t button_x, button_y;         /**< Window button position */
+    const struct _twin_shadow_patch *shadow; /**< Active window's shadow */
 
     /* Span buffer cache for screen updates */
     twin_argb32_t *span_cache;     /**< Cached span buffer */
@@ -370,21 +390,41 @@ struct _twin_screen {
  */
 typedef enum {
     TWIN_SOLID /**< Solid color source */,
-    TWIN_PIXMAP /**< Pixmap texture source */
+    TWIN_PIXMAP /**< Pixmap texture source */,
+    TWIN_LINEAR_GRADIENT /**< Linear gradient source */,
+    TWIN_RADIAL_GRADIENT /**< Radial gradient source */
 } twin_source_t;
 
+/**
+ * Two-color gradient, in source coordinates
+ *
+ * A linear gradient runs from color0 at (x0, y0) to color1 at (x1, y1)
+ * and is constant along lines perpendicular to that vector. A radial
+ * gradient runs from color0 at the center (x0, y0) to color1 on the
+ * circle through (x1, y1). Beyond either end the end color is repeated.
+ * Colors are premultiplied, like those of TWIN_SOLID operands.
+ */
+typedef struct _twin_gradient {
+    twin_fixed_t x0, y0;          /**< Start point, or center */
+    twin_fixed_t x1, y1;          /**< End point, or point on the rim */
+    twin_argb32_t color0, color1; /**< Colors at either end */
+} twin_gradient_t;
+
 /**
  * Drawing operand containing source data
  *
- * Represents a source for drawing operations, either a solid color
- * or a pixmap texture that can be composited onto destinations.
+ * Represents a source for drawing operations, either a solid color,
+ * a pixmap texture or a gradient that can be composited onto
+ * destinations. Gradients are evaluated span by span while compositing
+ * and can only be used as the source, not as the mask.
  */
 typedef struct _twin_operand {
     twin_source_t source_kind; /**< Type of source */
     union {
-        twin_pixmap_t *pixmap; /**< Source pixmap for texture operations */
-        twin_argb32_t argb;    /**< Solid color for fill operations */
-    } u;                       /**< Source data union */
+        twin_pixmap_t *pixmap;           /**< Source pixmap for textures */
+        twin_argb32_t argb;              /**< Solid color for fills */
+        const twin_gradient_t *gradient; /**< Gradient for gradient fills */
+    } u;                                 /**< Source data union */
 } twin_operand_t;
 
 /**
@@ -509,7 +549,8 @@ typedef struct _twin_font {
     signed char height;            /**< Font height */
 
     /* Runtime caching */
-    const twin_charmap_t *cur_page; /**< Currently cached page */
+    const twin_charmap_t *cur_page;      /**< Currently cached page */
+    struct _twin_page_index *page_index; /**< Page lookup, built on use */
 } twin_font_t;
 
 /* FIXME: one global font for now */
@@ -538,7 +579,7 @@ struct _twin_window {
     twin_screen_t *screen; /**< Parent screen */
     twin_pixmap_t *pixmap; /**< Window pixmap */
 
-    twin_coord_t shadow_x, shadow_y; /**< Shadow offset */
+    twin_coord_t shadow_x, shadow_y; /**< Shadow extent past the window */
 
     /* Window properties */
     twin_window_style_t style; /**< Window style */
@@ -555,6 +596,12 @@ struct _twin_window {
     void *client_data; /**< User data pointer */
     char *name;        /**< Window title */
 
+    /* Frame decoration last painted into the pixmap */
+    twin_pixmap_t *frame_pixmap; /**< Pixmap holding it, NULL if stale */
+    twin_coord_t frame_width;    /**< Client right edge when painted */
+    bool frame_active;           /**< Active state when painted */
+    bool frame_iconify;          /**< Iconify state when painted */
+
     /* Window callbacks */
     twin_draw_func_t draw;       /**< Draw callback */
     twin_event_func_t event;     /**< Event handler */
@@ -826,6 +873,60 @@ void twin_composite(twin_pixmap_t *dst,
                     twin_coord_t width,
                     twin_coord_t height);
 
+/**
+ * Composite source onto destination scaled by a constant alpha
+ * @dst      : Destination pixmap
+ * @dst_x    : Destination X offset
+ * @dst_y    : Destination Y offset
+ * @src      : Source operand (color or pixmap)
+ * @src_x    : Source X offset
+ * @src_y    : Source Y offset
+ * @alpha    : Global opacity applied to every source pixel (0xff = opaque)
+ * @operator : Compositing operation (OVER or SOURCE)
+ * @width    : Width of operation in pixels
+ * @height   : Height of operation in pixels
+ *
+ * Equivalent to twin_composite() with a constant mask, but without the
+ * caller building a mask operand.  Fades of windows and toasts use this
+ * and run at roughly the cost of a plain OVER.
+ */
+void twin_composite_alpha(twin_pixmap_t *dst,
+                          twin_coord_t dst_x,
+                          twin_coord_t dst_y,
+                          twin_operand_t *src,
+                          twin_coord_t src_x,
+                          twin_coord_t src_y,
+                          twin_a8_t alpha,
+                          twin_operator_t operator,
+                          twin_coord_t width,
+                          twin_coord_t height);
+
+/**
+ * Composite a nine-patch source stretched over a destination rectangle
+ * @dst      : Destination pixmap
+ * @dst_x    : Destination X offset
+ * @dst_y    : Destination Y offset
+ * @width    : Width of the destination rectangle
+ * @height   : Height of the destination rectangle
+ * @src      : Source pixmap holding the decoration at its natural size
+ * @insets   : Widths of the unscaled borders of @src on each side
+ * @operator : Compositing operation (OVER or SOURCE)
+ *
+ * Corners are copied as is, edges are stretched along their length and the
+ * centre in both directions, all by nearest-pixel column and row mapping
+ * instead of a transform.  When the width changes, the source rows are
+ * first stretched into a buffer that is kept between calls; the rows then
+ * composite in one block per run of consecutive source rows.
+ */
+void twin_composite_ninepatch(twin_pixmap_t *dst,
+                              twin_coord_t dst_x,
+                              twin_coord_t dst_y,
+                              twin_coord_t width,
+                              twin_coord_t height,
+                              twin_pixmap_t *src,
+                              twin_rect_t insets,
+                              twin_operator_t operator);
+
 /**
  * Fill rectangular region with solid color
  * @dst      : Destination pixmap
@@ -852,13 +953,14 @@ void twin_fill(twin_pixmap_t *dst,
  * @px     : Pixmap to blur (must be TWIN_ARGB32 format)
  * @radius : Blur radius (larger values create stronger blur)
  * @left   : Left edge of blur region
- * @right  : Right edge of blur region (inclusive)
+ * @right  : Right edge of blur region (exclusive)
  * @top    : Top edge of blur region
- * @bottom : Bottom edge of blur region (inclusive)
+ * @bottom : Bottom edge of blur region (exclusive)
  *
- * Applies a fast stack blur algorithm to create soft shadows,
- * gaussian-like blur effects, and smooth transitions. The blur
- * only affects the specified rectangular region.
+ * Approximates a Gaussian with the variance of a stack blur of the given
+ * radius using three box passes per axis, so the cost per pixel does not
+ * grow with the radius. The blur only affects the specified rectangular
+ * region, clipped to the pixmap.
  */
 void twin_stack_blur(twin_pixmap_t *px,
                      int radius,
@@ -896,6 +998,26 @@ twin_fixed_t twin_fixed_sqrt(twin_fixed_t a);
  */
 bool twin_has_ucs4(twin_font_t *font, twin_ucs4_t ucs4);
 
+/**
+ * Load a binary font file written by tools/ttf/twin-ttf -o
+ * @path : Path to the font file
+ *
+ * The file is mapped read-only and shared, so glyphs are paged in as they
+ * are drawn. Assign the result to g_twin_font to render with it.
+ *
+ * Return Loaded font, or NULL if the file is missing or malformed
+ */
+twin_font_t *twin_font_load(const char *path);
+
+/**
+ * Release a font returned by twin_font_load()
+ * @font : Font to release
+ *
+ * Cached glyphs of the font are dropped; if it is the current g_twin_font,
+ * the built-in default font is restored.
+ */
+void twin_font_destroy(twin_font_t *font);
+
 /**
  * Add stroked outline of Unicode character to path
  * @path : Path to add character outline to
@@ -923,6 +1045,23 @@ void twin_path_ucs4(twin_path_t *path, twin_ucs4_t ucs4);
  */
 void twin_path_utf8(twin_path_t *path, const char *string);
 
+/**
+ * Paint UTF-8 string with solid color
+ * @dst    : Destination pixmap
+ * @argb   : Text color
+ * @path   : Path supplying font, matrix and starting point
+ * @string : UTF-8 encoded string
+ *
+ * Equivalent to twin_path_utf8() followed by twin_paint_path() on a fresh
+ * path, without adding outlines to @path; its current point is advanced
+ * past the string. With CONFIG_GLYPH_CACHE, glyphs are drawn from cached
+ * coverage masks, positioned to a quarter pixel.
+ */
+void twin_paint_utf8(twin_pixmap_t *dst,
+                     twin_argb32_t argb,
+                     twin_path_t *path,
+                     const char *string);
+
 /**
  * Get advance width of Unicode character
  * @path : Path with current font settings
@@ -971,6 +1110,110 @@ void twin_icon_draw(twin_pixmap_t *pixmap,
 
 twin_pixmap_t *twin_pixmap_from_file(const char *path, twin_format_t fmt);
 
+/**
+ * Load an image no larger than a bounding box
+ * @path  : Image file path
+ * @fmt   : Pixel format of the returned pixmap
+ * @max_w : Maximum width, or 0 for no limit
+ * @max_h : Maximum height, or 0 for no limit
+ *
+ * Images larger than the box are reduced while decoding, keeping their
+ * aspect ratio: JPEG through libjpeg's DCT scaling, PNG by averaging rows
+ * as they are decoded, and TinyVG by rendering at the fitted scale.
+ * Smaller images and GIF animations are returned at native size.
+ */
+twin_pixmap_t *twin_pixmap_from_file_scaled(const char *path,
+                                            twin_format_t fmt,
+                                            twin_coord_t max_w,
+                                            twin_coord_t max_h);
+
+typedef struct _twin_image_load twin_image_load_t;
+
+typedef void (*twin_image_callback_t)(twin_pixmap_t *pixmap, void *closure);
+
+/**
+ * Load an image without blocking the dispatch loop
+ * @path     : Image file path
+ * @fmt      : Pixel format of the returned pixmap
+ * @callback : Called with the pixmap, or NULL if loading failed
+ * @closure  : Passed to @callback
+ *
+ * The file is decoded on a pool of worker threads (CONFIG_LOADER_ASYNC)
+ * and @callback runs later from the dispatch loop, like queued work; it
+ * takes ownership of the pixmap. Without thread support, pending images
+ * are decoded one per dispatch iteration instead. Requests start in the
+ * order they are made. Must be called from the thread running the
+ * dispatch loop.
+ *
+ * Returns a handle for twin_pixmap_load_cancel(), valid until @callback
+ * runs, or NULL if the request could not be queued.
+ */
+twin_image_load_t *twin_pixmap_from_file_async(const char *path,
+                                               twin_format_t fmt,
+                                               twin_image_callback_t callback,
+                                               void *closure);
+
+/**
+ * Cancel a pending twin_pixmap_from_file_async() request
+ * @load : Handle returned by the request
+ *
+ * Its callback will not be called and the decoded image, if any, is
+ * released. Call this before freeing anything the closure refers to.
+ */
+void twin_pixmap_load_cancel(twin_image_load_t *load);
+
+/**
+ * Decoded image cache statistics (CONFIG_IMAGE_CACHE)
+ */
+typedef struct _twin_image_cache_stats {
+    size_t hits;      /**< Lookups served from memory */
+    size_t misses;    /**< Lookups that decoded the file */
+    size_t evictions; /**< Unreferenced images dropped for the budget */
+    size_t entries;   /**< Images currently cached */
+    size_t bytes;     /**< Memory held by cached images */
+    size_t budget;    /**< Limit on bytes, see twin_image_cache_set_budget */
+} twin_image_cache_stats_t;
+
+/**
+ * Get a shared decoded image
+ * @path  : Image file path
+ * @fmt   : Pixel format of the returned pixmap
+ * @max_w : Maximum width, or 0 for no limit
+ * @max_h : Maximum height, or 0 for no limit
+ *
+ * Like twin_pixmap_from_file_scaled(), but images already decoded with
+ * the same arguments, from an unchanged file, are returned from memory.
+ * The pixmap is shared with other callers and must not be modified,
+ * including its transform, clip and origin; give it back with
+ * twin_image_cache_release() instead of destroying it. Animated images
+ * are never shared. Without CONFIG_IMAGE_CACHE every call decodes.
+ */
+twin_pixmap_t *twin_image_cache_get(const char *path,
+                                    twin_format_t fmt,
+                                    twin_coord_t max_w,
+                                    twin_coord_t max_h);
+
+/**
+ * Drop a reference taken by twin_image_cache_get()
+ * @pixmap : Pixmap to release
+ */
+void twin_image_cache_release(twin_pixmap_t *pixmap);
+
+/**
+ * Set the memory limit of the image cache
+ * @bytes : New limit
+ *
+ * Unreferenced images are evicted, least recently used first, while the
+ * cache holds more than @bytes. Images still in use are kept and may
+ * push it over the limit.
+ */
+void twin_image_cache_set_budget(size_t bytes);
+
+/* Evict every image that is not currently referenced. */
+void twin_image_cache_flush(void);
+
+void twin_image_cache_get_stats(twin_image_cache_stats_t *stats);
+
 /*
  * Defines the interface for managing frame-based animations.
  * It provides functions to control and manipulate animations such as getting
@@ -983,10 +1226,20 @@ twin_time_t twin_animation_get_current_delay(const twin_animation_t *anim);
 /* Get the current frame which should be displayed. */
 twin_pixmap_t *twin_animation_get_current_frame(const twin_animation_t *anim);
 
+/* Get the area of the current frame that differs from the frame shown before
+ * it. Streamed animations update a single frame pixmap in place, so a
+ * viewer that keeps the previous frame on screen only needs to redraw this
+ * area, and must do so before advancing again. */
+twin_rect_t twin_animation_get_current_damage(const twin_animation_t *anim);
+
 /* Advances the animation to the next frame. If the animation is looping, it
  * will return to the first frame after the last one. */
 void twin_animation_advance_frame(twin_animation_t *anim);
 
+/* Moves the animation to frame @index. Streamed animations resume decoding
+ * from the nearest keyframe rather than from the first frame. */
+void twin_animation_seek(twin_animation_t *anim, twin_count_t index);
+
 /* Frees the memory allocated for the animation, including all associated
  * frames.
  */
@@ -1271,6 +1524,27 @@ void twin_pixmap_damage(twin_pixmap_t *pixmap,
 
 void twin_pixmap_move(twin_pixmap_t *pixmap, twin_coord_t x, twin_coord_t y);
 
+/**
+ * Set the opacity used when the screen composites this pixmap
+ * @pixmap  : Pixmap to update
+ * @opacity : Constant alpha, 0 (invisible) to 0xff (opaque, the default)
+ *
+ * Damages the pixmap's screen area when the value changes, so stepping
+ * the opacity from a timeout animates a fade-in or fade-out.
+ */
+void twin_pixmap_set_opacity(twin_pixmap_t *pixmap, twin_a8_t opacity);
+
+twin_a8_t twin_pixmap_get_opacity(twin_pixmap_t *pixmap);
+
+/**
+ * Select how a transformed pixmap is sampled
+ * @pixmap : Source pixmap
+ * @filter : Sampling filter, see twin_filter_t
+ *
+ * Only affects composites that use a non-identity pixmap->transform.
+ */
+void twin_pixmap_set_filter(twin_pixmap_t *pixmap, twin_filter_t filter);
+
 
 bool twin_pixmap_transparent(twin_pixmap_t *pixmap,
                              twin_coord_t x,
@@ -1590,6 +1864,61 @@ twin_work_t *twin_set_work(twin_work_proc_t work_proc,
 
 void twin_clear_work(twin_work_t *work);
 
+/*
+ * Compiled TinyVG document
+ *
+ * The file is parsed once into fixed-point paths with their styles and
+ * bounds, which can then be drawn any number of times, at any scale,
+ * without reading the file again.
+ */
+typedef struct _twin_tvg twin_tvg_t;
+
+/**
+ * Parse a TinyVG file into a display list
+ * @filepath : Path to the .tvg file
+ * @return   : Compiled document, or NULL if the file cannot be read
+ */
+twin_tvg_t *twin_tvg_load(const char *filepath);
+
+void twin_tvg_destroy(twin_tvg_t *tvg);
+
+/**
+ * Get the size of a compiled document
+ * @tvg    : Compiled document
+ * @width  : Receives the width in document units
+ * @height : Receives the height in document units
+ */
+void twin_tvg_get_size(const twin_tvg_t *tvg,
+                       uint32_t *width,
+                       uint32_t *height);
+
+/**
+ * Draw a compiled document
+ * @tvg       : Compiled document
+ * @dst       : Destination pixmap
+ * @transform : Maps document units to pixels of @dst, NULL for identity
+ *
+ * Drawing goes through the clip and origin of @dst; parts of the document
+ * that fall outside the clip are skipped rather than rasterized, so a
+ * damaged region or a zoomed-in view only costs what it shows.
+ */
+void twin_tvg_render(const twin_tvg_t *tvg,
+                     twin_pixmap_t *dst,
+                     const twin_matrix_t *transform);
+
+/**
+ * Draw a compiled document into a new pixmap
+ * @tvg    : Compiled document
+ * @fmt    : Pixel format of the new pixmap
+ * @w      : Width of the new pixmap
+ * @h      : Height of the new pixmap
+ * @return : The pixmap, with the document scaled uniformly to fit
+ */
+twin_pixmap_t *twin_tvg_to_pixmap(const twin_tvg_t *tvg,
+                                  twin_format_t fmt,
+                                  twin_coord_t w,
+                                  twin_coord_t h);
+
 twin_pixmap_t *twin_tvg_to_pixmap_scale(const char *filepath,
                                         twin_format_t fmt,
                                         twin_coord_t w,
@@ -71,6 +71,8 @@ def generate_screen_ops_decls():
         "twin_op_func _twin_rgb16_source_argb32;",
         "twin_op_func _twin_argb32_over_argb32;",
         "twin_op_func _twin_argb32_source_argb32;",
+        "twin_in_op_func _twin_argb32_in_alpha_over_argb32;",
+        "twin_in_op_func _twin_rgb16_in_alpha_over_argb32;",
     ]
 
 
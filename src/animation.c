@@ -7,6 +7,25 @@
 
 #include "twin_private.h"
 
+static void _twin_animation_iter_show(twin_animation_iter_t *iter,
+                                      twin_count_t index)
+{
+    twin_animation_t *anim = iter->anim;
+    twin_rect_t damage = {0, anim->width, 0, anim->height};
+
+    if (anim->stream) {
+        iter->current_frame =
+            anim->stream->frame(anim->stream, index, &damage);
+    } else {
+        if (iter->current_frame && index == iter->current_index)
+            damage = (twin_rect_t){0, 0, 0, 0};
+        iter->current_frame = anim->frames[index];
+    }
+    iter->current_index = index;
+    iter->current_delay = anim->frame_delays[index];
+    iter->current_damage = damage;
+}
+
 twin_time_t twin_animation_get_current_delay(const twin_animation_t *anim)
 {
     if (!anim)
@@ -21,6 +40,13 @@ twin_pixmap_t *twin_animation_get_current_frame(const twin_animation_t *anim)
     return anim->iter->current_frame;
 }
 
+twin_rect_t twin_animation_get_current_damage(const twin_animation_t *anim)
+{
+    if (!anim)
+        return (twin_rect_t){0, 0, 0, 0};
+    return anim->iter->current_damage;
+}
+
 void twin_animation_advance_frame(twin_animation_t *anim)
 {
     if (!anim)
@@ -28,13 +54,22 @@ void twin_animation_advance_frame(twin_animation_t *anim)
     twin_animation_iter_advance(anim->iter);
 }
 
+void twin_animation_seek(twin_animation_t *anim, twin_count_t index)
+{
+    if (!anim || index < 0 || index >= anim->n_frames)
+        return;
+    _twin_animation_iter_show(anim->iter, index);
+}
+
 void twin_animation_destroy(twin_animation_t *anim)
 {
     if (!anim)
         return;
 
     twin_free(anim->iter);
-    for (twin_count_t i = 0; i < anim->n_frames; i++) {
+    if (anim->stream)
+        anim->stream->destroy(anim->stream);
+    for (twin_count_t i = 0; anim->frames && i < anim->n_frames; i++) {
         twin_pixmap_destroy(anim->frames[i]);
     }
     twin_free(anim->frames);
@@ -47,25 +82,24 @@ twin_animation_iter_t *twin_animation_iter_init(twin_animation_t *anim)
     twin_animation_iter_t *iter = twin_malloc(sizeof(twin_animation_iter_t));
     if (!iter || !anim)
         return NULL;
-    iter->current_index = 0;
-    iter->current_frame = anim->frames[0];
-    iter->current_delay = anim->frame_delays[0];
-    anim->iter = iter;
     iter->anim = anim;
+    iter->current_frame = NULL;
+    _twin_animation_iter_show(iter, 0);
+    anim->iter = iter;
     return iter;
 }
 
 void twin_animation_iter_advance(twin_animation_iter_t *iter)
 {
     twin_animation_t *anim = iter->anim;
-    iter->current_index++;
-    if (iter->current_index >= anim->n_frames) {
+    twin_count_t index = iter->current_index + 1;
+
+    if (index >= anim->n_frames) {
         if (anim->loop) {
-            iter->current_index = 0;
+            index = 0;
         } else {
-            iter->current_index = anim->n_frames - 1;
+            index = anim->n_frames - 1;
         }
     }
-    iter->current_frame = anim->frames[iter->current_index];
-    iter->current_delay = anim->frame_delays[iter->current_index];
+    _twin_animation_iter_show(iter, index);
 }
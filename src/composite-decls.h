@@ -0,0 +1,163 @@
+/*
+ * Compositing operation function declarations
+ *
+ * These functions are generated by macros in:
+ * - src/draw-builtin.c (when CONFIG_RENDERER_BUILTIN=y)
+ * - src/screen-ops.c (always available)
+ *
+ * This file is auto-generated by the build system - DO NOT EDIT
+ */
+
+#ifndef _TWIN_COMPOSITE_DECLS_H_
+#define _TWIN_COMPOSITE_DECLS_H_
+
+/* Forward declarations for function types */
+typedef void twin_in_op_func(twin_pointer_t dst,
+                             twin_source_u src,
+                             twin_source_u msk,
+                             int width);
+
+typedef void twin_op_func(twin_pointer_t dst, twin_source_u src, int width);
+
+
+/* Essential screen compositing (always available from screen-ops.c) */
+twin_op_func _twin_rgb16_source_argb32;
+twin_op_func _twin_argb32_over_argb32;
+twin_op_func _twin_argb32_source_argb32;
+twin_in_op_func _twin_argb32_in_alpha_over_argb32;
+twin_in_op_func _twin_rgb16_in_alpha_over_argb32;
+
+/* 3-operand compositing: _twin_{src}_in_{msk}_{op}_{dst} */
+/* Total: 2 ops * 3 dsts * 4 srcs * 4 msks = 96 functions */
+/* Only available when CONFIG_RENDERER_BUILTIN=y */
+twin_in_op_func _twin_argb32_in_argb32_over_argb32;
+twin_in_op_func _twin_argb32_in_rgb16_over_argb32;
+twin_in_op_func _twin_argb32_in_a8_over_argb32;
+twin_in_op_func _twin_argb32_in_c_over_argb32;
+twin_in_op_func _twin_rgb16_in_argb32_over_argb32;
+twin_in_op_func _twin_rgb16_in_rgb16_over_argb32;
+twin_in_op_func _twin_rgb16_in_a8_over_argb32;
+twin_in_op_func _twin_rgb16_in_c_over_argb32;
+twin_in_op_func _twin_a8_in_argb32_over_argb32;
+twin_in_op_func _twin_a8_in_rgb16_over_argb32;
+twin_in_op_func _twin_a8_in_a8_over_argb32;
+twin_in_op_func _twin_a8_in_c_over_argb32;
+twin_in_op_func _twin_c_in_argb32_over_argb32;
+twin_in_op_func _twin_c_in_rgb16_over_argb32;
+twin_in_op_func _twin_c_in_a8_over_argb32;
+twin_in_op_func _twin_c_in_c_over_argb32;
+twin_in_op_func _twin_argb32_in_argb32_over_rgb16;
+twin_in_op_func _twin_argb32_in_rgb16_over_rgb16;
+twin_in_op_func _twin_argb32_in_a8_over_rgb16;
+twin_in_op_func _twin_argb32_in_c_over_rgb16;
+twin_in_op_func _twin_rgb16_in_argb32_over_rgb16;
+twin_in_op_func _twin_rgb16_in_rgb16_over_rgb16;
+twin_in_op_func _twin_rgb16_in_a8_over_rgb16;
+twin_in_op_func _twin_rgb16_in_c_over_rgb16;
+twin_in_op_func _twin_a8_in_argb32_over_rgb16;
+twin_in_op_func _twin_a8_in_rgb16_over_rgb16;
+twin_in_op_func _twin_a8_in_a8_over_rgb16;
+twin_in_op_func _twin_a8_in_c_over_rgb16;
+twin_in_op_func _twin_c_in_argb32_over_rgb16;
+twin_in_op_func _twin_c_in_rgb16_over_rgb16;
+twin_in_op_func _twin_c_in_a8_over_rgb16;
+twin_in_op_func _twin_c_in_c_over_rgb16;
+twin_in_op_func _twin_argb32_in_argb32_over_a8;
+twin_in_op_func _twin_argb32_in_rgb16_over_a8;
+twin_in_op_func _twin_argb32_in_a8_over_a8;
+twin_in_op_func _twin_argb32_in_c_over_a8;
+twin_in_op_func _twin_rgb16_in_argb32_over_a8;
+twin_in_op_func _twin_rgb16_in_rgb16_over_a8;
+twin_in_op_func _twin_rgb16_in_a8_over_a8;
+twin_in_op_func _twin_rgb16_in_c_over_a8;
+twin_in_op_func _twin_a8_in_argb32_over_a8;
+twin_in_op_func _twin_a8_in_rgb16_over_a8;
+twin_in_op_func _twin_a8_in_a8_over_a8;
+twin_in_op_func _twin_a8_in_c_over_a8;
+twin_in_op_func _twin_c_in_argb32_over_a8;
+twin_in_op_func _twin_c_in_rgb16_over_a8;
+twin_in_op_func _twin_c_in_a8_over_a8;
+twin_in_op_func _twin_c_in_c_over_a8;
+twin_in_op_func _twin_argb32_in_argb32_source_argb32;
+twin_in_op_func _twin_argb32_in_rgb16_source_argb32;
+twin_in_op_func _twin_argb32_in_a8_source_argb32;
+twin_in_op_func _twin_argb32_in_c_source_argb32;
+twin_in_op_func _twin_rgb16_in_argb32_source_argb32;
+twin_in_op_func _twin_rgb16_in_rgb16_source_argb32;
+twin_in_op_func _twin_rgb16_in_a8_source_argb32;
+twin_in_op_func _twin_rgb16_in_c_source_argb32;
+twin_in_op_func _twin_a8_in_argb32_source_argb32;
+twin_in_op_func _twin_a8_in_rgb16_source_argb32;
+twin_in_op_func _twin_a8_in_a8_source_argb32;
+twin_in_op_func _twin_a8_in_c_source_argb32;
+twin_in_op_func _twin_c_in_argb32_source_argb32;
+twin_in_op_func _twin_c_in_rgb16_source_argb32;
+twin_in_op_func _twin_c_in_a8_source_argb32;
+twin_in_op_func _twin_c_in_c_source_argb32;
+twin_in_op_func _twin_argb32_in_argb32_source_rgb16;
+twin_in_op_func _twin_argb32_in_rgb16_source_rgb16;
+twin_in_op_func _twin_argb32_in_a8_source_rgb16;
+twin_in_op_func _twin_argb32_in_c_source_rgb16;
+twin_in_op_func _twin_rgb16_in_argb32_source_rgb16;
+twin_in_op_func _twin_rgb16_in_rgb16_source_rgb16;
+twin_in_op_func _twin_rgb16_in_a8_source_rgb16;
+twin_in_op_func _twin_rgb16_in_c_source_rgb16;
+twin_in_op_func _twin_a8_in_argb32_source_rgb16;
+twin_in_op_func _twin_a8_in_rgb16_source_rgb16;
+twin_in_op_func _twin_a8_in_a8_source_rgb16;
+twin_in_op_func _twin_a8_in_c_source_rgb16;
+twin_in_op_func _twin_c_in_argb32_source_rgb16;
+twin_in_op_func _twin_c_in_rgb16_source_rgb16;
+twin_in_op_func _twin_c_in_a8_source_rgb16;
+twin_in_op_func _twin_c_in_c_source_rgb16;
+twin_in_op_func _twin_argb32_in_argb32_source_a8;
+twin_in_op_func _twin_argb32_in_rgb16_source_a8;
+twin_in_op_func _twin_argb32_in_a8_source_a8;
+twin_in_op_func _twin_argb32_in_c_source_a8;
+twin_in_op_func _twin_rgb16_in_argb32_source_a8;
+twin_in_op_func _twin_rgb16_in_rgb16_source_a8;
+twin_in_op_func _twin_rgb16_in_a8_source_a8;
+twin_in_op_func _twin_rgb16_in_c_source_a8;
+twin_in_op_func _twin_a8_in_argb32_source_a8;
+twin_in_op_func _twin_a8_in_rgb16_source_a8;
+twin_in_op_func _twin_a8_in_a8_source_a8;
+twin_in_op_func _twin_a8_in_c_source_a8;
+twin_in_op_func _twin_c_in_argb32_source_a8;
+twin_in_op_func _twin_c_in_rgb16_source_a8;
+twin_in_op_func _twin_c_in_a8_source_a8;
+twin_in_op_func _twin_c_in_c_source_a8;
+
+/* 2-operand compositing: _twin_{src}_{op}_{dst} */
+/* Total: 2 ops * 3 dsts * 4 srcs = 24 functions */
+/* Only available when CONFIG_RENDERER_BUILTIN=y */
+twin_op_func _twin_argb32_over_argb32;
+twin_op_func _twin_rgb16_over_argb32;
+twin_op_func _twin_a8_over_argb32;
+twin_op_func _twin_c_over_argb32;
+twin_op_func _twin_argb32_over_rgb16;
+twin_op_func _twin_rgb16_over_rgb16;
+twin_op_func _twin_a8_over_rgb16;
+twin_op_func _twin_c_over_rgb16;
+twin_op_func _twin_argb32_over_a8;
+twin_op_func _twin_rgb16_over_a8;
+twin_op_func _twin_a8_over_a8;
+twin_op_func _twin_c_over_a8;
+twin_op_func _twin_argb32_source_argb32;
+twin_op_func _twin_rgb16_source_argb32;
+twin_op_func _twin_a8_source_argb32;
+twin_op_func _twin_c_source_argb32;
+twin_op_func _twin_argb32_source_rgb16;
+twin_op_func _twin_rgb16_source_rgb16;
+twin_op_func _twin_a8_source_rgb16;
+twin_op_func _twin_c_source_rgb16;
+twin_op_func _twin_argb32_source_a8;
+twin_op_func _twin_rgb16_source_a8;
+twin_op_func _twin_a8_source_a8;
+twin_op_func _twin_c_source_a8;
+
+/* Vectorized implementations (hand-optimized) */
+twin_op_func _twin_vec_argb32_over_argb32;
+twin_op_func _twin_vec_argb32_source_argb32;
+
+#endif /* _TWIN_COMPOSITE_DECLS_H_ */
+
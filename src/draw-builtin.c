@@ -254,13 +254,22 @@ MAKE_TWIN_in_op_dsts_srcs_msks(over) MAKE_TWIN_in_op_dsts_srcs_msks(source)
     CAT2(MAKE_TWIN_, op)(dst, c)
 
 #define MAKE_TWIN_op_dsts_srcs(op)      \
-    MAKE_TWIN_op_srcs(op, argb32)       \
     MAKE_TWIN_op_srcs(op, rgb16)        \
     MAKE_TWIN_op_srcs(op, a8)
 
     MAKE_TWIN_op_dsts_srcs(over);
     MAKE_TWIN_op_dsts_srcs(source);
 
+/*
+ * ARGB32 destinations: argb32 over argb32, argb32 source argb32 and
+ * rgb16 source argb32 are the screen kernels in screen-ops.c.
+ */
+    MAKE_TWIN_over(argb32, rgb16)
+    MAKE_TWIN_over(argb32, a8)
+    MAKE_TWIN_over(argb32, c)
+    MAKE_TWIN_source(argb32, a8)
+    MAKE_TWIN_source(argb32, c)
+
 /* clang-format on */
 
 /* Built-in Renderer Implementation
@@ -382,7 +391,7 @@ static const twin_src_msk_op comp3[2][4][4][3] = {
                         /* C */
                         _twin_rgb16_in_c_over_a8,
                         _twin_rgb16_in_c_over_rgb16,
-                        _twin_rgb16_in_c_over_argb32,
+                        _twin_rgb16_in_alpha_over_argb32,
                     },
                 },
             [TWIN_ARGB32] =
@@ -409,7 +418,7 @@ static const twin_src_msk_op comp3[2][4][4][3] = {
                         /* C */
                         _twin_argb32_in_c_over_a8,
                         _twin_argb32_in_c_over_rgb16,
-                        _twin_argb32_in_c_over_argb32,
+                        _twin_argb32_in_alpha_over_argb32,
                     },
                 },
             {
@@ -657,6 +666,71 @@ static inline int operand_xindex(twin_operand_t *o)
     return ind != TWIN_RGB16 ? ind : TWIN_ARGB32;
 }
 
+#define FX(x) twin_int_to_fixed(x)
+#define XF(x) twin_fixed_to_int(x)
+
+static twin_xform_kind_t twin_xform_classify(const twin_pixmap_t *pixmap)
+{
+    const twin_matrix_t *m = &pixmap->transform;
+
+    if (m->m[0][1] || m->m[1][0])
+        return pixmap->filter == TWIN_FILTER_NEAREST ? TWIN_XFORM_NEAREST
+                                                     : TWIN_XFORM_GENERAL;
+    /* Every filter reduces to a plain copy on integer translations */
+    if (m->m[0][0] == TWIN_FIXED_ONE && m->m[1][1] == TWIN_FIXED_ONE &&
+        !(m->m[2][0] & 0xffff) && !(m->m[2][1] & 0xffff))
+        return TWIN_XFORM_TRANSLATE;
+    if (pixmap->filter == TWIN_FILTER_NEAREST)
+        return TWIN_XFORM_SCALE_NEAREST;
+    /* Box only pays off once bilinear starts skipping source pixels */
+    if (pixmap->filter == TWIN_FILTER_BOX && m->m[0][0] >= TWIN_FIXED_ONE &&
+        m->m[1][1] >= TWIN_FIXED_ONE &&
+        (m->m[0][0] > 2 * TWIN_FIXED_ONE || m->m[1][1] > 2 * TWIN_FIXED_ONE))
+        return TWIN_XFORM_BOX;
+    return TWIN_XFORM_SCALE;
+}
+
+static inline int32_t _pix_clip_col(const twin_pixmap_t *pix, int32_t x)
+{
+    return (x >= pix->clip.left && x < pix->clip.right) ? x : -1;
+}
+
+static void twin_xform_init_cols(twin_xform_t *xform)
+{
+    twin_pixmap_t *pix = xform->pixmap;
+    twin_matrix_t *tfm = &pix->transform;
+    twin_fixed_t base = tfm->m[2][0] + FX(xform->src_x);
+
+    for (twin_coord_t i = 0; i < xform->width; i++) {
+        twin_fixed_t sx = twin_fixed_mul(tfm->m[0][0], FX(i)) + base;
+        twin_xform_col_t *col = &xform->cols[i];
+        int32_t x0 = XF(sx);
+
+        switch (xform->kind) {
+        case TWIN_XFORM_SCALE_NEAREST:
+            col->x0 = _pix_clip_col(pix, XF(sx + TWIN_FIXED_ONE / 2));
+            col->x1 = -1;
+            col->wx = 0;
+            break;
+        case TWIN_XFORM_BOX: {
+            int32_t x1 = XF(sx + tfm->m[0][0]);
+
+            if (x1 <= x0)
+                x1 = x0 + 1;
+            col->wx = x1 - x0;
+            col->x0 = x0 < pix->clip.left ? pix->clip.left : x0;
+            col->x1 = x1 > pix->clip.right ? pix->clip.right : x1;
+            break;
+        }
+        default:
+            col->x0 = _pix_clip_col(pix, x0);
+            col->x1 = _pix_clip_col(pix, x0 + 1);
+            col->wx = sx & 0xffff;
+            break;
+        }
+    }
+}
+
 static twin_xform_t *twin_pixmap_init_xform(twin_pixmap_t *pixmap,
                                             twin_coord_t left,
                                             twin_coord_t width,
@@ -664,12 +738,17 @@ static twin_xform_t *twin_pixmap_init_xform(twin_pixmap_t *pixmap,
                                             twin_coord_t src_y)
 {
     twin_format_t fmt = pixmap->format;
+    twin_xform_kind_t kind = twin_xform_classify(pixmap);
+    size_t cols_size = 0;
 
     if (fmt == TWIN_RGB16)
         fmt = TWIN_ARGB32;
 
-    size_t required_size =
-        sizeof(twin_xform_t) + (size_t) width * twin_bytes_per_pixel(fmt);
+    if (kind >= TWIN_XFORM_SCALE)
+        cols_size = (size_t) width * sizeof(twin_xform_col_t);
+
+    size_t required_size = sizeof(twin_xform_t) + cols_size +
+                           (size_t) width * twin_bytes_per_pixel(fmt);
 
     /* Reuse cached xform buffer if large enough */
     twin_xform_t *xform;
@@ -685,12 +764,18 @@ static twin_xform_t *twin_pixmap_init_xform(twin_pixmap_t *pixmap,
         xform = (twin_xform_t *) new_cache;
     }
 
-    xform->span.v = (twin_argb32_t *) (char *) (xform + 1);
+    /* Column table first: it needs the stricter alignment */
+    xform->cols = (twin_xform_col_t *) (xform + 1);
+    xform->span.v = (char *) (xform + 1) + cols_size;
     xform->pixmap = pixmap;
     xform->left = left;
     xform->width = width;
     xform->src_x = src_x;
     xform->src_y = src_y;
+    xform->kind = kind;
+
+    if (kind >= TWIN_XFORM_SCALE)
+        twin_xform_init_cols(xform);
 
     return xform;
 }
@@ -702,9 +787,6 @@ static void twin_pixmap_free_xform(twin_xform_t *xform)
     (void) xform;
 }
 
-#define FX(x) twin_int_to_fixed(x)
-#define XF(x) twin_fixed_to_int(x)
-
 /* we are doing clipping on source... dunno if that makes much sense
  * but here we go ... if we decide that source clipping makes no sense
  * then we need to still test wether we fit in the pixmap boundaries
@@ -724,11 +806,13 @@ static void twin_pixmap_free_xform(twin_xform_t *xform)
 
 #define _get_pix_16(d, pix, x, y)                                            \
     do {                                                                     \
-        twin_rgb16_t p =                                                     \
+        twin_argb32_t p =                                                    \
             _pix_clipped(pix, x, y)                                          \
                 ? 0                                                          \
-                : *((pix)->p.argb32 + XF(y) * ((pix)->stride >> 1) + XF(x)); \
-        *((twin_argb32_t *) (char *) (d)) = twin_rgb16_to_argb32(p);         \
+                : twin_rgb16_to_argb32(*((pix)->p.rgb16 +                    \
+                                         XF(y) * ((pix)->stride >> 1) +      \
+                                         XF(x)));                            \
+        *((twin_argb32_t *) (char *) (d)) = p;                               \
     } while (0)
 
 #define _get_pix_32(d, pix, x, y)                                            \
@@ -832,9 +916,277 @@ static void twin_pixmap_read_xform_32(twin_xform_t *xform, twin_coord_t line)
     }
 }
 
-static void twin_pixmap_read_xform(twin_xform_t *xform, twin_coord_t line)
+/*
+ * Integer translation: every destination pixel lands exactly on a source
+ * pixel, where the bilinear filter reduces to the top-left sample.
+ */
+static void twin_pixmap_read_xform_translate(twin_xform_t *xform,
+                                             twin_coord_t line)
+{
+    twin_pixmap_t *pix = xform->pixmap;
+    twin_matrix_t *tfm = &pix->transform;
+    int32_t sx = XF(tfm->m[2][0]) + xform->src_x;
+    int32_t sy = XF(tfm->m[2][1]) + xform->src_y + line;
+    int32_t bpp = twin_bytes_per_pixel(pix->format);
+    int32_t out_bpp = pix->format == TWIN_A8 ? 1 : 4;
+    int32_t start = 0, end = xform->width;
+    twin_pointer_t src, dst = xform->span;
+
+    if (sy < pix->clip.top || sy >= pix->clip.bottom) {
+        memset(dst.v, 0, (size_t) xform->width * out_bpp);
+        return;
+    }
+    if (sx < pix->clip.left)
+        start = pix->clip.left - sx;
+    if (sx + end > pix->clip.right)
+        end = pix->clip.right - sx;
+    if (start >= end) {
+        memset(dst.v, 0, (size_t) xform->width * out_bpp);
+        return;
+    }
+
+    memset(dst.v, 0, (size_t) start * out_bpp);
+    src.b = pix->p.b + sy * pix->stride + (sx + start) * bpp;
+    if (pix->format == TWIN_RGB16) {
+        for (int32_t i = start; i < end; i++)
+            dst.argb32[i] = twin_rgb16_to_argb32(src.rgb16[i - start]);
+    } else {
+        memcpy(dst.b + start * out_bpp, src.v, (size_t) (end - start) * bpp);
+    }
+    memset(dst.b + end * out_bpp, 0, (size_t) (xform->width - end) * out_bpp);
+}
+
+static inline twin_argb32_t _pix_saucemix_32(twin_argb32_t tl,
+                                             twin_argb32_t tr,
+                                             twin_argb32_t bl,
+                                             twin_argb32_t br,
+                                             unsigned int wx,
+                                             unsigned int wy)
+{
+    twin_argb32_t v = 0;
+
+    for (int i = 0; i < 32; i += 8) {
+        unsigned int a = (tl >> i) & 0xff, b = (tr >> i) & 0xff;
+        unsigned int c = (bl >> i) & 0xff, d = (br >> i) & 0xff;
+
+        v |= (twin_argb32_t) (twin_a8_t) _pix_saucemix(a, b, c, d, wx, wy)
+             << i;
+    }
+    return v;
+}
+
+/*
+ * Axis-aligned scale: the source row and vertical weight are computed once
+ * per line, the columns come from the table built by twin_xform_init_cols().
+ */
+#define _pix_scale_row(pix, sy)                                     \
+    ((sy) >= (pix)->clip.top && (sy) < (pix)->clip.bottom           \
+         ? (pix)->p.b + (sy) * (pix)->stride                        \
+         : NULL)
+
+static void twin_pixmap_read_xform_scale(twin_xform_t *xform,
+                                         twin_coord_t line)
+{
+    twin_pixmap_t *pix = xform->pixmap;
+    twin_matrix_t *tfm = &pix->transform;
+    twin_fixed_t sy = twin_fixed_mul(tfm->m[1][1], FX(line)) + tfm->m[2][1] +
+                      FX(xform->src_y);
+    unsigned int wy = sy & 0xffff;
+    uint8_t *r0 = _pix_scale_row(pix, XF(sy));
+    uint8_t *r1 = _pix_scale_row(pix, XF(sy) + 1);
+    twin_xform_col_t *col = xform->cols;
+    twin_coord_t i;
+
+    switch (pix->format) {
+    case TWIN_A8: {
+        twin_a8_t *dst = xform->span.a8;
+
+        for (i = 0; i < xform->width; i++, col++) {
+            unsigned int tl = 0, tr = 0, bl = 0, br = 0;
+
+            if (r0) {
+                tl = col->x0 < 0 ? 0 : r0[col->x0];
+                tr = col->x1 < 0 ? 0 : r0[col->x1];
+            }
+            if (r1) {
+                bl = col->x0 < 0 ? 0 : r1[col->x0];
+                br = col->x1 < 0 ? 0 : r1[col->x1];
+            }
+            dst[i] = _pix_saucemix(tl, tr, bl, br, col->wx, wy);
+        }
+        break;
+    }
+    case TWIN_RGB16: {
+        twin_rgb16_t *s0 = (twin_rgb16_t *) r0, *s1 = (twin_rgb16_t *) r1;
+        twin_argb32_t *dst = xform->span.argb32;
+
+        for (i = 0; i < xform->width; i++, col++) {
+            twin_argb32_t tl = 0, tr = 0, bl = 0, br = 0;
+
+            if (s0) {
+                tl = col->x0 < 0 ? 0 : twin_rgb16_to_argb32(s0[col->x0]);
+                tr = col->x1 < 0 ? 0 : twin_rgb16_to_argb32(s0[col->x1]);
+            }
+            if (s1) {
+                bl = col->x0 < 0 ? 0 : twin_rgb16_to_argb32(s1[col->x0]);
+                br = col->x1 < 0 ? 0 : twin_rgb16_to_argb32(s1[col->x1]);
+            }
+            dst[i] = _pix_saucemix_32(tl, tr, bl, br, col->wx, wy);
+        }
+        break;
+    }
+    case TWIN_ARGB32: {
+        twin_argb32_t *s0 = (twin_argb32_t *) r0, *s1 = (twin_argb32_t *) r1;
+        twin_argb32_t *dst = xform->span.argb32;
+
+        for (i = 0; i < xform->width; i++, col++) {
+            twin_argb32_t tl = 0, tr = 0, bl = 0, br = 0;
+
+            if (s0) {
+                tl = col->x0 < 0 ? 0 : s0[col->x0];
+                tr = col->x1 < 0 ? 0 : s0[col->x1];
+            }
+            if (s1) {
+                bl = col->x0 < 0 ? 0 : s1[col->x0];
+                br = col->x1 < 0 ? 0 : s1[col->x1];
+            }
+            dst[i] = (tl | tr | bl | br)
+                         ? _pix_saucemix_32(tl, tr, bl, br, col->wx, wy)
+                         : 0;
+        }
+        break;
+    }
+    }
+}
+
+static inline twin_argb32_t _pix_fetch(const twin_pixmap_t *pix,
+                                       const uint8_t *row,
+                                       int32_t x)
+{
+    if (!row || x < 0)
+        return 0;
+    switch (pix->format) {
+    case TWIN_A8:
+        return row[x];
+    case TWIN_RGB16:
+        return twin_rgb16_to_argb32(((const twin_rgb16_t *) row)[x]);
+    default:
+        return ((const twin_argb32_t *) row)[x];
+    }
+}
+
+static inline void _pix_store(twin_xform_t *xform,
+                              twin_coord_t i,
+                              twin_argb32_t v)
 {
     if (xform->pixmap->format == TWIN_A8)
+        xform->span.a8[i] = v;
+    else
+        xform->span.argb32[i] = v;
+}
+
+/* Nearest sampling under an arbitrary matrix */
+static void twin_pixmap_read_xform_nearest(twin_xform_t *xform,
+                                           twin_coord_t line)
+{
+    twin_pixmap_t *pix = xform->pixmap;
+    twin_matrix_t *tfm = &pix->transform;
+    twin_fixed_t dy = FX(line);
+    twin_fixed_t ox = FX(xform->src_x) + TWIN_FIXED_ONE / 2;
+    twin_fixed_t oy = FX(xform->src_y) + TWIN_FIXED_ONE / 2;
+
+    for (twin_coord_t i = 0; i < xform->width; i++) {
+        twin_fixed_t sx = _twin_matrix_fx(tfm, FX(i), dy) + ox;
+        twin_fixed_t sy = _twin_matrix_fy(tfm, FX(i), dy) + oy;
+        twin_argb32_t v = 0;
+
+        if (!_pix_clipped(pix, sx, sy))
+            v = _pix_fetch(pix, pix->p.b + XF(sy) * pix->stride, XF(sx));
+        _pix_store(xform, i, v);
+    }
+}
+
+static void twin_pixmap_read_xform_scale_nearest(twin_xform_t *xform,
+                                                 twin_coord_t line)
+{
+    twin_pixmap_t *pix = xform->pixmap;
+    twin_matrix_t *tfm = &pix->transform;
+    twin_fixed_t sy = twin_fixed_mul(tfm->m[1][1], FX(line)) + tfm->m[2][1] +
+                      FX(xform->src_y) + TWIN_FIXED_ONE / 2;
+    uint8_t *row = _pix_scale_row(pix, XF(sy));
+    twin_xform_col_t *col = xform->cols;
+    twin_coord_t i;
+
+    if (pix->format == TWIN_ARGB32) {
+        twin_argb32_t *src = (twin_argb32_t *) row;
+
+        for (i = 0; i < xform->width; i++, col++)
+            xform->span.argb32[i] = (!src || col->x0 < 0) ? 0 : src[col->x0];
+        return;
+    }
+    for (i = 0; i < xform->width; i++, col++)
+        _pix_store(xform, i, _pix_fetch(pix, row, col->x0));
+}
+
+/*
+ * Area average for large downscales.  Each destination pixel covers a
+ * box of roughly m[0][0] x m[1][1] source pixels; clipped pixels count as
+ * transparent, matching the other samplers.
+ */
+static void twin_pixmap_read_xform_box(twin_xform_t *xform, twin_coord_t line)
+{
+    twin_pixmap_t *pix = xform->pixmap;
+    twin_matrix_t *tfm = &pix->transform;
+    twin_fixed_t sy = twin_fixed_mul(tfm->m[1][1], FX(line)) + tfm->m[2][1] +
+                      FX(xform->src_y);
+    int32_t y0 = XF(sy), y1 = XF(sy + tfm->m[1][1]);
+    uint32_t h;
+    twin_xform_col_t *col = xform->cols;
+
+    if (y1 <= y0)
+        y1 = y0 + 1;
+    h = y1 - y0;
+    if (y0 < pix->clip.top)
+        y0 = pix->clip.top;
+    if (y1 > pix->clip.bottom)
+        y1 = pix->clip.bottom;
+
+    for (twin_coord_t i = 0; i < xform->width; i++, col++) {
+        uint32_t sum[4] = {0, 0, 0, 0};
+        uint32_t area = col->wx * h;
+        twin_argb32_t v = 0;
+
+        for (int32_t y = y0; y < y1; y++) {
+            const uint8_t *row = pix->p.b + y * pix->stride;
+
+            for (int32_t x = col->x0; x < col->x1; x++) {
+                twin_argb32_t p = _pix_fetch(pix, row, x);
+
+                sum[0] += p & 0xff;
+                sum[1] += (p >> 8) & 0xff;
+                sum[2] += (p >> 16) & 0xff;
+                sum[3] += p >> 24;
+            }
+        }
+        for (int c = 0; c < 4; c++)
+            v |= ((sum[c] + area / 2) / area) << (c * 8);
+        _pix_store(xform, i, v);
+    }
+}
+
+static void twin_pixmap_read_xform(twin_xform_t *xform, twin_coord_t line)
+{
+    if (xform->kind == TWIN_XFORM_TRANSLATE)
+        twin_pixmap_read_xform_translate(xform, line);
+    else if (xform->kind == TWIN_XFORM_SCALE)
+        twin_pixmap_read_xform_scale(xform, line);
+    else if (xform->kind == TWIN_XFORM_SCALE_NEAREST)
+        twin_pixmap_read_xform_scale_nearest(xform, line);
+    else if (xform->kind == TWIN_XFORM_BOX)
+        twin_pixmap_read_xform_box(xform, line);
+    else if (xform->kind == TWIN_XFORM_NEAREST)
+        twin_pixmap_read_xform_nearest(xform, line);
+    else if (xform->pixmap->format == TWIN_A8)
         twin_pixmap_read_xform_8(xform, line);
     else if (xform->pixmap->format == TWIN_RGB16)
         twin_pixmap_read_xform_16(xform, line);
@@ -932,6 +1284,214 @@ static void _twin_composite_xform(twin_pixmap_t *dst,
     twin_pixmap_free_xform(mxform);
 }
 
+/*
+ * Gradient sources
+ *
+ * Gradients never exist as pixels: each row is generated a chunk at a time
+ * into a small span on the stack and handed to the usual ARGB32 operators.
+ * Colors come from a table built once per composite. Linear gradients step
+ * a fixed-point parameter by a constant per pixel; radial gradients step
+ * the squared distance to the center and take one square root per pixel.
+ * Positions are sampled at pixel centers.
+ */
+#define TWIN_GRADIENT_LUT_SIZE 256
+#define TWIN_GRADIENT_CHUNK 64
+
+typedef struct {
+    twin_source_t kind;
+    /* linear: parameter with 24 fraction bits, and its step per pixel */
+    int64_t dt_dx, dt_dy;
+    /* radial: offsets in 24.8, squared radius, and 2^48 / radius^2 */
+    twin_fixed_t x0, y0;
+    int64_t r2, inv_r2;
+    twin_argb32_t lut[TWIN_GRADIENT_LUT_SIZE];
+} twin_gradient_span_t;
+
+static void twin_gradient_init(twin_gradient_span_t *gs,
+                               twin_source_t kind,
+                               const twin_gradient_t *g)
+{
+    int64_t dx = (g->x1 - g->x0) >> 8, dy = (g->y1 - g->y0) >> 8;
+    int64_t len2 = dx * dx + dy * dy;
+
+    for (int i = 0; i < TWIN_GRADIENT_LUT_SIZE; i++) {
+        twin_argb32_t c = 0;
+
+        for (int s = 0; s < 32; s += 8) {
+            uint32_t c0 = (g->color0 >> s) & 0xff, c1 = (g->color1 >> s) & 0xff;
+
+            c |= ((c0 * (255 - i) + c1 * i + 127) / 255) << s;
+        }
+        gs->lut[i] = c;
+    }
+
+    gs->kind = kind;
+    gs->x0 = g->x0;
+    gs->y0 = g->y0;
+    gs->dt_dx = gs->dt_dy = 0;
+    gs->r2 = len2;
+    gs->inv_r2 = len2 ? ((int64_t) 1 << 48) / len2 : 0;
+    if (kind == TWIN_LINEAR_GRADIENT && len2) {
+        /* dx and dy are negative pointing left or up, so never shift them */
+        gs->dt_dx = dx * ((int64_t) 1 << 32) / len2;
+        gs->dt_dy = dy * ((int64_t) 1 << 32) / len2;
+    }
+}
+
+/* Fill @span with @n pixels of row @y starting at column @x */
+static void twin_gradient_read(const twin_gradient_span_t *gs,
+                               twin_argb32_t *span,
+                               twin_coord_t x,
+                               twin_coord_t y,
+                               twin_coord_t n)
+{
+    twin_fixed_t px = twin_int_to_fixed(x) + TWIN_FIXED_ONE / 2 - gs->x0;
+    twin_fixed_t py = twin_int_to_fixed(y) + TWIN_FIXED_ONE / 2 - gs->y0;
+    const twin_argb32_t *lut = gs->lut;
+
+    /* A gradient without length is all past its end */
+    if (!gs->r2) {
+        for (twin_coord_t i = 0; i < n; i++)
+            span[i] = lut[TWIN_GRADIENT_LUT_SIZE - 1];
+        return;
+    }
+
+    if (gs->kind == TWIN_LINEAR_GRADIENT) {
+        int64_t t = (gs->dt_dx * px + gs->dt_dy * py) >> 16;
+
+        for (twin_coord_t i = 0; i < n; i++, t += gs->dt_dx) {
+            if (t <= 0)
+                span[i] = lut[0];
+            else if (t >= (int64_t) 1 << 24)
+                span[i] = lut[TWIN_GRADIENT_LUT_SIZE - 1];
+            else
+                span[i] = lut[t >> 16];
+        }
+        return;
+    }
+
+    int64_t dx = px >> 8, dy = py >> 8;
+    int64_t d2 = dx * dx + dy * dy;
+
+    for (twin_coord_t i = 0; i < n; i++) {
+        if (d2 >= gs->r2) {
+            span[i] = lut[TWIN_GRADIENT_LUT_SIZE - 1];
+        } else {
+            /* (d / r)^2, then d / r, both in 16.16 */
+            twin_fixed_t t2 = (twin_fixed_t) ((d2 * gs->inv_r2) >> 32);
+            int32_t idx = twin_fixed_sqrt(t2) >> 8;
+
+            span[i] = lut[idx < TWIN_GRADIENT_LUT_SIZE
+                              ? idx
+                              : TWIN_GRADIENT_LUT_SIZE - 1];
+        }
+        /* (dx + 1)^2 = dx^2 + 2 dx + 1, one pixel being 256 */
+        d2 += 512 * dx + 65536;
+        dx += 256;
+    }
+}
+
+static void _twin_composite_gradient(twin_pixmap_t *dst,
+                                     twin_coord_t dst_x,
+                                     twin_coord_t dst_y,
+                                     twin_operand_t *src,
+                                     twin_coord_t src_x,
+                                     twin_coord_t src_y,
+                                     twin_operand_t *msk,
+                                     twin_coord_t msk_x,
+                                     twin_coord_t msk_y,
+                                     twin_operator_t operator,
+                                     twin_coord_t width,
+                                     twin_coord_t height)
+{
+    twin_coord_t left, top, right, bottom;
+    twin_gradient_span_t gs;
+    twin_argb32_t span[TWIN_GRADIENT_CHUNK];
+    twin_source_u s = {.p.argb32 = span};
+
+    dst_x += dst->origin_x;
+    dst_y += dst->origin_y;
+    left = dst_x;
+    top = dst_y;
+    right = dst_x + width;
+    bottom = dst_y + height;
+
+    /* clip */
+    if (left < dst->clip.left)
+        left = dst->clip.left;
+    if (top < dst->clip.top)
+        top = dst->clip.top;
+    if (right > dst->clip.right)
+        right = dst->clip.right;
+    if (bottom > dst->clip.bottom)
+        bottom = dst->clip.bottom;
+
+    if (left >= right || top >= bottom)
+        return;
+
+    /* Source position of the top-left destination pixel */
+    src_x += left - dst_x;
+    src_y += top - dst_y;
+    twin_gradient_init(&gs, src->source_kind, src->u.gradient);
+
+    if (msk) {
+        twin_pixmap_t *mpix = msk->u.pixmap;
+        twin_xform_t *mxform = NULL;
+        twin_source_u m;
+        int mbpp = 0;
+        int mind = operand_index(msk);
+
+        msk_x += left - dst_x;
+        msk_y += top - dst_y;
+        if (msk->source_kind == TWIN_PIXMAP) {
+            msk_x += mpix->origin_x;
+            msk_y += mpix->origin_y;
+            if (!twin_matrix_is_identity(&mpix->transform)) {
+                mxform = twin_pixmap_init_xform(mpix, left, right - left,
+                                                msk_x, msk_y);
+                if (!mxform)
+                    return;
+                mind = operand_xindex(msk);
+            }
+            mbpp = mind == TWIN_A8 ? 1 : mind == TWIN_RGB16 ? 2 : 4;
+        } else {
+            m.c = msk->u.argb;
+        }
+
+        twin_src_msk_op op = comp3[operator][TWIN_ARGB32][mind][dst->format];
+        for (twin_coord_t iy = top; iy < bottom; iy++) {
+            if (mxform)
+                twin_pixmap_read_xform(mxform, iy - top);
+            for (twin_coord_t x = left, n; x < right; x += n) {
+                n = right - x < TWIN_GRADIENT_CHUNK ? right - x
+                                                    : TWIN_GRADIENT_CHUNK;
+                twin_gradient_read(&gs, span, src_x + x - left,
+                                   src_y + iy - top, n);
+                if (mxform)
+                    m.p.b = mxform->span.b + (x - left) * mbpp;
+                else if (msk->source_kind == TWIN_PIXMAP)
+                    m.p = twin_pixmap_pointer(mpix, msk_x + x - left,
+                                              msk_y + iy - top);
+                (*op)(twin_pixmap_pointer(dst, x, iy), s, m, n);
+            }
+        }
+        twin_pixmap_free_xform(mxform);
+    } else {
+        twin_src_op op = comp2[operator][TWIN_ARGB32][dst->format];
+
+        for (twin_coord_t iy = top; iy < bottom; iy++) {
+            for (twin_coord_t x = left, n; x < right; x += n) {
+                n = right - x < TWIN_GRADIENT_CHUNK ? right - x
+                                                    : TWIN_GRADIENT_CHUNK;
+                twin_gradient_read(&gs, span, src_x + x - left,
+                                   src_y + iy - top, n);
+                (*op)(twin_pixmap_pointer(dst, x, iy), s, n);
+            }
+        }
+    }
+    twin_pixmap_damage(dst, left, top, right, bottom);
+}
+
 void twin_composite(twin_pixmap_t *dst,
                     twin_coord_t dst_x,
                     twin_coord_t dst_y,
@@ -945,10 +1505,18 @@ void twin_composite(twin_pixmap_t *dst,
                     twin_coord_t width,
                     twin_coord_t height)
 {
-    if ((src->source_kind == TWIN_PIXMAP &&
-         !twin_matrix_is_identity(&src->u.pixmap->transform)) ||
-        (msk && (msk->source_kind == TWIN_PIXMAP &&
-                 !twin_matrix_is_identity(&msk->u.pixmap->transform)))) {
+    /* Gradients are only defined as a source */
+    if (msk && (msk->source_kind == TWIN_LINEAR_GRADIENT ||
+                msk->source_kind == TWIN_RADIAL_GRADIENT))
+        return;
+    if (src->source_kind == TWIN_LINEAR_GRADIENT ||
+        src->source_kind == TWIN_RADIAL_GRADIENT) {
+        _twin_composite_gradient(dst, dst_x, dst_y, src, src_x, src_y, msk,
+                                 msk_x, msk_y, operator, width, height);
+    } else if ((src->source_kind == TWIN_PIXMAP &&
+                !twin_matrix_is_identity(&src->u.pixmap->transform)) ||
+               (msk && (msk->source_kind == TWIN_PIXMAP &&
+                        !twin_matrix_is_identity(&msk->u.pixmap->transform)))) {
         _twin_composite_xform(dst, dst_x, dst_y, src, src_x, src_y, msk, msk_x,
                               msk_y, operator, width, height);
     } else {
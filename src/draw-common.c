@@ -8,121 +8,118 @@
 #include "shadow-gaussian-lut.h"
 #include "twin_private.h"
 
-static void _twin_apply_stack_blur(twin_pixmap_t *trg_px,
-                                   twin_pixmap_t *src_px,
-                                   int radius,
-                                   int first_str,
-                                   int first_end,
-                                   int second_str,
-                                   int second_end,
-                                   bool horiz_scan)
+/*
+ * The blur runs three successive box filters per axis.  Their widths are
+ * picked so the combined kernel has the variance of the triangular
+ * (radius + 1)^2 stack-blur kernel, which approximates a Gaussian far better
+ * than a single box while keeping the per-pixel cost independent of the
+ * radius: each box is a running sum updated by one add and one subtract.
+ */
+#define TWIN_BLUR_BOXES 3
+
+/*
+ * A pixel widened into two 64-bit words holding R/B and A/G in 32-bit
+ * lanes, so one add updates two channel sums at once.  A lane sum is at
+ * most 255 * width, and multiplying it by 2^24 / width stays below 2^32,
+ * so the division also handles both lanes with a single multiply.
+ */
+typedef struct _twin_blur_px {
+    uint64_t rb, ag;
+} twin_blur_px_t;
+
+typedef struct _twin_blur_box {
+    int radius;
+    uint32_t inv; /* 2^24 / width */
+} twin_blur_box_t;
+
+#define TWIN_BLUR_LANES 0x000000ff000000ffULL
+#define TWIN_BLUR_ROUND ((1ULL << 55) | (1ULL << 23))
+
+static inline twin_blur_px_t _twin_blur_widen(twin_argb32_t p)
 {
-    int den = (radius + 1) * (radius + 1);
-    twin_pointer_t src_ptr, trg_ptr, old_ptr, new_ptr;
-    twin_argb32_t sumInR, sumOutR, sumR, sumInG, sumOutG, sumG, sumInB, sumOutB,
-        sumB, sumInA, sumOutA, sumA, _cur, _old, _new, _src;
-    uint16_t tmpR, tmpG, tmpB, tmpA;
-    for (int first = first_str; first < first_end; first++) {
-        sumInR = sumOutR = sumR = sumInG = sumOutG = sumG = sumInB = sumOutB =
-            sumB = sumInA = sumOutA = sumA = 0x00000000;
-
-        /* Initialize sumOut by padding. */
-        if (horiz_scan)
-            src_ptr = twin_pixmap_pointer(src_px, second_str, first);
-        else
-            src_ptr = twin_pixmap_pointer(src_px, first, second_str);
-        _src = *src_ptr.argb32;
-
-        for (int i = second_str; i < second_str + radius; i++) {
-            sumOutR = _twin_add_ARGB(sumOutR, _src, 0, tmpR);
-            sumOutG = _twin_add_ARGB(sumOutG, _src, 8, tmpG);
-            sumOutB = _twin_add_ARGB(sumOutB, _src, 16, tmpB);
-            sumOutA = _twin_add_ARGB(sumOutA, _src, 24, tmpA);
-            for (int j = 0; j < (i - second_str) + 1; j++) {
-                sumR = _twin_add_ARGB(sumR, _src, 0, tmpR);
-                sumG = _twin_add_ARGB(sumG, _src, 8, tmpG);
-                sumB = _twin_add_ARGB(sumB, _src, 16, tmpB);
-                sumA = _twin_add_ARGB(sumA, _src, 24, tmpA);
-            }
-        }
+    twin_blur_px_t w = {
+        .rb = (p & 0xff) | (uint64_t) (p & 0xff0000) << 16,
+        .ag = ((p >> 8) & 0xff) | (uint64_t) (p >> 24) << 32,
+    };
+    return w;
+}
 
-        /* Initialize sumIn. */
-        for (int i = second_str; i < second_str + radius; i++) {
-            if (horiz_scan)
-                src_ptr = twin_pixmap_pointer(src_px, i, first);
-            else
-                src_ptr = twin_pixmap_pointer(src_px, first, i);
-            _src = *src_ptr.argb32;
-            sumInR = _twin_add_ARGB(sumInR, _src, 0, tmpR);
-            sumInG = _twin_add_ARGB(sumInG, _src, 8, tmpG);
-            sumInB = _twin_add_ARGB(sumInB, _src, 16, tmpB);
-            sumInA = _twin_add_ARGB(sumInA, _src, 24, tmpA);
-            for (int j = 0; j < radius - (i - second_str); j++) {
-                sumR = _twin_add_ARGB(sumR, _src, 0, tmpR);
-                sumG = _twin_add_ARGB(sumG, _src, 8, tmpG);
-                sumB = _twin_add_ARGB(sumB, _src, 16, tmpB);
-                sumA = _twin_add_ARGB(sumA, _src, 24, tmpA);
-            }
-        }
+static inline twin_argb32_t _twin_blur_pack(twin_blur_px_t w)
+{
+    return (twin_argb32_t) (w.rb | w.rb >> 16) |
+           (twin_argb32_t) (w.ag | w.ag >> 16) << 8;
+}
 
-        for (int cur = second_str; cur < second_end; cur++) {
-            if (horiz_scan) {
-                src_ptr = twin_pixmap_pointer(src_px, cur, first);
-                trg_ptr = twin_pixmap_pointer(trg_px, cur, first);
-                old_ptr = twin_pixmap_pointer(
-                    src_px, max(cur - radius, second_str), first);
-                new_ptr = twin_pixmap_pointer(
-                    src_px, min(cur + radius, second_end - 1), first);
-            } else {
-                src_ptr = twin_pixmap_pointer(src_px, first, cur);
-                trg_ptr = twin_pixmap_pointer(trg_px, first, cur);
-                old_ptr = twin_pixmap_pointer(src_px, first,
-                                              max(cur - radius, second_str));
-                new_ptr = twin_pixmap_pointer(
-                    src_px, first, min(cur + radius, second_end - 1));
-            }
-            _cur = *src_ptr.argb32;
-            _old = *old_ptr.argb32;
-            _new = *new_ptr.argb32;
-            /* STEP 1 : sumOut + current */
-            sumOutR = _twin_add_ARGB(sumOutR, _cur, 0, tmpR);
-            sumOutG = _twin_add_ARGB(sumOutG, _cur, 8, tmpG);
-            sumOutB = _twin_add_ARGB(sumOutB, _cur, 16, tmpB);
-            sumOutA = _twin_add_ARGB(sumOutA, _cur, 24, tmpA);
-            /* STEP 2 : sumIn + new */
-            sumInR = _twin_add_ARGB(sumInR, _new, 0, tmpR);
-            sumInG = _twin_add_ARGB(sumInG, _new, 8, tmpG);
-            sumInB = _twin_add_ARGB(sumInB, _new, 16, tmpB);
-            sumInA = _twin_add_ARGB(sumInA, _new, 24, tmpA);
-            /* STEP 3 : sum + sumIn */
-            sumR = _twin_add(sumR, sumInR, tmpR);
-            sumG = _twin_add(sumG, sumInG, tmpG);
-            sumB = _twin_add(sumB, sumInB, tmpB);
-            sumA = _twin_add(sumA, sumInA, tmpA);
-            /* STEP 4 : sum / denominator */
-            *trg_ptr.argb32 =
-                (_twin_div(sumR, den, 0, tmpR) | _twin_div(sumG, den, 8, tmpG) |
-                 _twin_div(sumB, den, 16, tmpB) |
-                 _twin_div(sumA, den, 24, tmpA));
-            /* STEP 5 : sum - sumOut */
-            sumR = _twin_sub(sumR, sumOutR, tmpR);
-            sumG = _twin_sub(sumG, sumOutG, tmpG);
-            sumB = _twin_sub(sumB, sumOutB, tmpB);
-            sumA = _twin_sub(sumA, sumOutA, tmpA);
-            /* STEP 6 : sumOut - old */
-            sumOutR = _twin_sub_ARGB(sumOutR, _old, 0, tmpR);
-            sumOutG = _twin_sub_ARGB(sumOutG, _old, 8, tmpG);
-            sumOutB = _twin_sub_ARGB(sumOutB, _old, 16, tmpB);
-            sumOutA = _twin_sub_ARGB(sumOutA, _old, 24, tmpA);
-            /* STEP 7 : sumIn - current */
-            sumInR = _twin_sub_ARGB(sumInR, _cur, 0, tmpR);
-            sumInG = _twin_sub_ARGB(sumInG, _cur, 8, tmpG);
-            sumInB = _twin_sub_ARGB(sumInB, _cur, 16, tmpB);
-            sumInA = _twin_sub_ARGB(sumInA, _cur, 24, tmpA);
-        }
+static void _twin_blur_boxes(int radius, twin_blur_box_t boxes[])
+{
+    /* Twelve times the variance of the stack-blur kernel. */
+    int var12 = 2 * radius * (radius + 2);
+    int ideal = 1, lower, num, den, m;
+
+    while ((ideal + 1) * (ideal + 1) <= var12 / TWIN_BLUR_BOXES + 1)
+        ideal++;
+    lower = (ideal & 1) ? ideal : ideal - 1;
+
+    /* Use the lower odd width for the first m boxes, lower + 2 after. */
+    num = TWIN_BLUR_BOXES * (lower + 1) * (lower + 3) - var12;
+    den = 4 * (lower + 1);
+    m = num > 0 ? (num + den / 2) / den : 0;
+    for (int i = 0; i < TWIN_BLUR_BOXES; i++) {
+        int width = i < m ? lower : lower + 2;
+        boxes[i].radius = width >> 1;
+        boxes[i].inv = ((1U << 24) + width / 2) / width;
+    }
+}
+
+/* Box-filter one line of n pixels, replicating the end pixels past edges. */
+static void _twin_blur_box_line(twin_blur_px_t *dst,
+                                const twin_blur_px_t *src,
+                                int n,
+                                const twin_blur_box_t *box)
+{
+    int r = box->radius;
+    uint64_t rb = src[0].rb * (r + 1), ag = src[0].ag * (r + 1);
+
+    for (int i = 1; i <= r; i++) {
+        rb += src[i < n ? i : n - 1].rb;
+        ag += src[i < n ? i : n - 1].ag;
+    }
+    for (int i = 0; i < n; i++) {
+        const twin_blur_px_t *in = &src[i + r + 1 < n ? i + r + 1 : n - 1];
+        const twin_blur_px_t *out = &src[i - r > 0 ? i - r : 0];
+        dst[i].rb = ((rb * box->inv + TWIN_BLUR_ROUND) >> 24) & TWIN_BLUR_LANES;
+        dst[i].ag = ((ag * box->inv + TWIN_BLUR_ROUND) >> 24) & TWIN_BLUR_LANES;
+        rb += in->rb - out->rb;
+        ag += in->ag - out->ag;
     }
 }
 
+/*
+ * Blur a line of n pixels read with the given pixel step and write it back
+ * with another step, so either side can walk a row or a column.
+ */
+static void _twin_blur_line(twin_argb32_t *dst,
+                            ptrdiff_t dst_step,
+                            const twin_argb32_t *src,
+                            ptrdiff_t src_step,
+                            int n,
+                            const twin_blur_box_t boxes[],
+                            twin_blur_px_t *line_a,
+                            twin_blur_px_t *line_b)
+{
+    for (int i = 0; i < n; i++)
+        line_a[i] = _twin_blur_widen(src[i * src_step]);
+    for (int b = 0; b < TWIN_BLUR_BOXES; b++) {
+        twin_blur_px_t *t;
+        if (!boxes[b].radius)
+            continue;
+        _twin_blur_box_line(line_b, line_a, n, &boxes[b]);
+        t = line_a, line_a = line_b, line_b = t;
+    }
+    for (int i = 0; i < n; i++)
+        dst[i * dst_step] = _twin_blur_pack(line_a[i]);
+}
+
 void twin_stack_blur(twin_pixmap_t *px,
                      int radius,
                      twin_coord_t left,
@@ -130,24 +127,56 @@ void twin_stack_blur(twin_pixmap_t *px,
                      twin_coord_t top,
                      twin_coord_t bottom)
 {
-    if (px->format != TWIN_ARGB32)
+    twin_blur_box_t boxes[TWIN_BLUR_BOXES];
+    twin_blur_px_t *line_a, *line_b;
+    twin_argb32_t *cols;
+    ptrdiff_t stride;
+    int width, height, n;
+
+    if (px->format != TWIN_ARGB32 || radius <= 0)
         return;
-    twin_pixmap_t *tmp_px =
-        twin_pixmap_create(px->format, px->width, px->height);
-    memcpy(tmp_px->p.v, px->p.v,
-           px->width * px->height * twin_bytes_per_pixel(px->format));
+    if (left < 0)
+        left = 0;
+    if (top < 0)
+        top = 0;
+    if (right > px->width)
+        right = px->width;
+    if (bottom > px->height)
+        bottom = px->height;
+    width = right - left;
+    height = bottom - top;
+    if (width <= 0 || height <= 0)
+        return;
+
+    n = width > height ? width : height;
+    cols = twin_malloc((size_t) width * height * sizeof(*cols));
+    line_a = twin_malloc(2 * (size_t) n * sizeof(*line_a));
+    if (!cols || !line_a) {
+        twin_free(cols);
+        twin_free(line_a);
+        return;
+    }
+    line_b = line_a + n;
+    _twin_blur_boxes(radius, boxes);
+
     /*
-     * Originally, performing a 2D convolution on each pixel takes O(width *
-     * height * k²). However, by first scanning horizontally and then vertically
-     * across the pixel map, and applying a 1D convolution to each pixel, the
-     * complexity is reduced to O(2 * width * height * k).
+     * Blur the rows and store them transposed, so the vertical pass reads
+     * each column as a contiguous line instead of striding through the
+     * pixmap for every box.
      */
-    /* Horizontally scan. */
-    _twin_apply_stack_blur(tmp_px, px, radius, top, bottom, left, right, true);
-    /* Vertically scan. */
-    _twin_apply_stack_blur(px, tmp_px, radius, left, right, top, bottom, false);
-    twin_pixmap_destroy(tmp_px);
-    return;
+    stride = px->stride / sizeof(twin_argb32_t);
+    for (int y = 0; y < height; y++)
+        _twin_blur_line(cols + y, height,
+                        twin_pixmap_pointer(px, left, top + y).argb32, 1,
+                        width, boxes, line_a, line_b);
+
+    /* Blur the columns and transpose them back into the pixmap. */
+    for (int x = 0; x < width; x++)
+        _twin_blur_line(twin_pixmap_pointer(px, left + x, top).argb32, stride,
+                        cols + (size_t) x * height, 1, height, boxes, line_a,
+                        line_b);
+    twin_free(line_a);
+    twin_free(cols);
 }
 
 #if defined(CONFIG_DROP_SHADOW)
@@ -209,10 +238,12 @@ static inline twin_fixed_t shadow_gaussian_weight(twin_fixed_t t)
  * - The shadow quality and performance are tied to the fixed-point precision
  *   and the size of the lookup table (i.e., 'shadow_gaussian_lut').
  */
-void twin_shadow_border(twin_pixmap_t *shadow, twin_argb32_t color)
+void twin_shadow_border(twin_pixmap_t *shadow,
+                        twin_window_style_t style,
+                        twin_argb32_t color)
 {
-    twin_coord_t win_width = shadow->width - shadow->window->shadow_x;
-    twin_coord_t win_height = shadow->height - shadow->window->shadow_y;
+    twin_coord_t win_width = shadow->width - TWIN_SHADOW_EXTENT_X;
+    twin_coord_t win_height = shadow->height - TWIN_SHADOW_EXTENT_Y;
     twin_coord_t y_start;
 
     twin_a8_t base_alpha = (color >> 24) & 0xFF;
@@ -225,7 +256,7 @@ void twin_shadow_border(twin_pixmap_t *shadow, twin_argb32_t color)
         return;
 
     /* Title-style windows leave the frame untouched by the shadow strip. */
-    switch (shadow->window->style) {
+    switch (style) {
     case TwinWindowApplication:
         /* Start below the title bar and apply the configured vertical offset.
          */
@@ -239,8 +270,8 @@ void twin_shadow_border(twin_pixmap_t *shadow, twin_argb32_t color)
 
     const twin_coord_t lut_x_len = x_offset + fade_tail;
     const twin_coord_t lut_y_len = y_offset + fade_tail;
-    twin_coord_t right_extent = shadow->window->shadow_x;
-    twin_coord_t bottom_extent = shadow->window->shadow_y;
+    twin_coord_t right_extent = TWIN_SHADOW_EXTENT_X;
+    twin_coord_t bottom_extent = TWIN_SHADOW_EXTENT_Y;
 
     /* Shadow mask rendering assumes ARGB32 pixel layout throughout. */
     if (shadow->format != TWIN_ARGB32)
@@ -445,6 +476,100 @@ void twin_shadow_border(twin_pixmap_t *shadow, twin_argb32_t color)
     }
 }
 
+/*
+ * Blurred shadows of a prototype window, keyed by everything that shapes
+ * them.  The screen stretches the middle of a patch to the size of the
+ * shadowed window, so one entry serves every window of the same style.
+ */
+#define TWIN_SHADOW_CACHE_SIZE 4
+/* Rows and columns past a feature edge that the blur still reaches. */
+#define TWIN_SHADOW_SUPPORT(blur) (2 * (blur) + 1)
+/* Stretched samples along the bottom strip's horizontal fade. */
+#define TWIN_SHADOW_PATCH_MIDDLE 64
+
+typedef struct _twin_shadow_cache {
+    twin_window_style_t style; /* Selects the strip start row */
+    int blur;                  /* Blur radius */
+    twin_argb32_t color;       /* Shadow colour */
+    uint32_t stamp;            /* Last use, for replacement */
+    int refs;                  /* Holders, which pin the entry */
+    twin_shadow_patch_t patch;
+} twin_shadow_cache_t;
+
+static twin_shadow_cache_t shadow_cache[TWIN_SHADOW_CACHE_SIZE];
+static uint32_t shadow_cache_clock;
+
+const twin_shadow_patch_t *twin_shadow_patch(twin_window_style_t style,
+                                             twin_argb32_t color,
+                                             int blur)
+{
+    twin_shadow_cache_t *victim = NULL;
+    twin_shadow_patch_t patch;
+    twin_coord_t support = TWIN_SHADOW_SUPPORT(blur > 0 ? blur : 0);
+
+    for (int i = 0; i < TWIN_SHADOW_CACHE_SIZE; i++) {
+        twin_shadow_cache_t *e = &shadow_cache[i];
+        if (e->patch.pixmap && e->style == style && e->blur == blur &&
+            e->color == color) {
+            e->stamp = ++shadow_cache_clock;
+            e->refs++;
+            return &e->patch;
+        }
+        if (!e->refs && (!victim || e->stamp < victim->stamp))
+            victim = e;
+    }
+    if (!victim)
+        return NULL;
+
+    /*
+     * Size the prototype so every blurred feature lands in a fixed border:
+     * the strip start and the corner never meet across the middle row, and
+     * the right margin keeps its full width.
+     */
+    patch.top = CONFIG_VERTICAL_OFFSET + support;
+    if (style == TwinWindowApplication)
+        patch.top += TWIN_TITLE_HEIGHT;
+    patch.bottom = TWIN_SHADOW_EXTENT_Y + support;
+    patch.left = CONFIG_HORIZONTAL_OFFSET + support;
+    patch.right = TWIN_SHADOW_EXTENT_X + support;
+    patch.pixmap = twin_pixmap_create(
+        TWIN_ARGB32, patch.left + TWIN_SHADOW_PATCH_MIDDLE + patch.right,
+        patch.top + 1 + patch.bottom);
+    if (!patch.pixmap)
+        return NULL;
+
+    twin_shadow_border(patch.pixmap, style, color);
+    if (blur > 0) {
+        twin_pixmap_t *px = patch.pixmap;
+        twin_coord_t shadow_left = px->width - TWIN_SHADOW_EXTENT_X;
+        twin_coord_t shadow_top = px->height - TWIN_SHADOW_EXTENT_Y;
+
+        /* Right side of the window, then the bottom side. */
+        twin_stack_blur(px, blur, shadow_left, px->width, 0, px->height);
+        twin_stack_blur(px, blur, 0, px->width, shadow_top, px->height);
+    }
+
+    if (victim->patch.pixmap)
+        twin_pixmap_destroy(victim->patch.pixmap);
+    victim->style = style;
+    victim->blur = blur;
+    victim->color = color;
+    victim->stamp = ++shadow_cache_clock;
+    victim->refs = 1;
+    victim->patch = patch;
+    return &victim->patch;
+}
+
+void twin_shadow_patch_release(const twin_shadow_patch_t *patch)
+{
+    for (int i = 0; i < TWIN_SHADOW_CACHE_SIZE; i++) {
+        if (&shadow_cache[i].patch == patch) {
+            shadow_cache[i].refs--;
+            return;
+        }
+    }
+}
+
 #undef SHADOW_LUT_X_LEN
 #undef SHADOW_LUT_Y_LEN
 #endif
@@ -503,3 +628,130 @@ void twin_cover(twin_pixmap_t *dst,
         *pt.argb32 = color;
     }
 }
+
+void twin_composite_alpha(twin_pixmap_t *dst,
+                          twin_coord_t dst_x,
+                          twin_coord_t dst_y,
+                          twin_operand_t *src,
+                          twin_coord_t src_x,
+                          twin_coord_t src_y,
+                          twin_a8_t alpha,
+                          twin_operator_t operator,
+                          twin_coord_t width,
+                          twin_coord_t height)
+{
+    twin_operand_t msk;
+
+    if (alpha == 0xff) {
+        twin_composite(dst, dst_x, dst_y, src, src_x, src_y, NULL, 0, 0,
+                       operator, width, height);
+        return;
+    }
+    if (!alpha && operator == TWIN_OVER)
+        return;
+
+    /* Fold the alpha into a solid color rather than masking it per pixel */
+    if (src->source_kind == TWIN_SOLID) {
+        twin_operand_t solid = {.source_kind = TWIN_SOLID};
+        twin_argb32_t c = src->u.argb;
+        uint16_t t1, t2, t3, t4;
+
+        solid.u.argb = twin_in(c, 0, alpha, t1) | twin_in(c, 8, alpha, t2) |
+                       twin_in(c, 16, alpha, t3) | twin_in(c, 24, alpha, t4);
+        twin_composite(dst, dst_x, dst_y, &solid, 0, 0, NULL, 0, 0, operator,
+                       width, height);
+        return;
+    }
+
+    msk.source_kind = TWIN_SOLID;
+    msk.u.argb = (twin_argb32_t) alpha << 24;
+    twin_composite(dst, dst_x, dst_y, src, src_x, src_y, &msk, 0, 0, operator,
+                   width, height);
+}
+
+/*
+ * Columns of a nine-patch stretched to the destination width.  The pixmap
+ * is kept between calls and only replaced to grow, so repainting the same
+ * widgets does not allocate.
+ */
+static twin_pixmap_t *ninepatch_cols;
+
+static twin_pixmap_t *_twin_ninepatch_cols(twin_format_t format,
+                                           twin_coord_t width,
+                                           twin_coord_t height)
+{
+    twin_pixmap_t *cols = ninepatch_cols;
+
+    if (cols && cols->format == format) {
+        if (cols->width >= width && cols->height >= height)
+            return cols;
+        if (cols->width > width)
+            width = cols->width;
+        if (cols->height > height)
+            height = cols->height;
+    }
+    cols = twin_pixmap_create(format, width, height);
+    if (!cols)
+        return NULL;
+    if (ninepatch_cols)
+        twin_pixmap_destroy(ninepatch_cols);
+    ninepatch_cols = cols;
+    return cols;
+}
+
+void twin_composite_ninepatch(twin_pixmap_t *dst,
+                              twin_coord_t dst_x,
+                              twin_coord_t dst_y,
+                              twin_coord_t width,
+                              twin_coord_t height,
+                              twin_pixmap_t *src,
+                              twin_rect_t insets,
+                              twin_operator_t operator)
+{
+    twin_operand_t srco = {.source_kind = TWIN_PIXMAP, .u.pixmap = src};
+    twin_coord_t y, run, sy;
+
+    if (width <= 0 || height <= 0 || src->width <= 0 || src->height <= 0)
+        return;
+    if (insets.left + insets.right > src->width)
+        insets.right = src->width - insets.left;
+    if (insets.top + insets.bottom > src->height)
+        insets.bottom = src->height - insets.top;
+
+    /*
+     * Stretch the columns once into a buffer at least as wide as the
+     * destination; each of its rows then copies straight onto every
+     * destination row it maps to.
+     */
+    if (width != src->width) {
+        int bpp = twin_bytes_per_pixel(src->format);
+        twin_pixmap_t *cols =
+            _twin_ninepatch_cols(src->format, width, src->height);
+        if (!cols)
+            return;
+        for (sy = 0; sy < src->height; sy++) {
+            uint8_t *s = twin_pixmap_pointer(src, 0, sy).b;
+            uint8_t *d = twin_pixmap_pointer(cols, 0, sy).b;
+            for (twin_coord_t x = 0; x < width; x++, d += bpp)
+                memcpy(d,
+                       s + _twin_ninepatch_map(x, width, src->width,
+                                               insets.left, insets.right) *
+                               bpp,
+                       bpp);
+        }
+        srco.u.pixmap = cols;
+    }
+
+    /* Rows that map to consecutive source rows composite as one block. */
+    for (y = 0; y < height; y += run) {
+        sy = _twin_ninepatch_map(y, height, src->height, insets.top,
+                                 insets.bottom);
+        for (run = 1; y + run < height; run++) {
+            if (_twin_ninepatch_map(y + run, height, src->height, insets.top,
+                                    insets.bottom) != sy + run)
+                break;
+        }
+        twin_composite(dst, dst_x, dst_y + y, &srco, 0, sy, NULL, 0, 0,
+                       operator, width, run);
+    }
+}
@@ -50,7 +50,42 @@ static pixman_op_t twin_to_pixman_op(const twin_operator_t twin_op)
                                  (_pixmap)->p.argb32, (_pixmap)->stride);  \
     })
 
-static void pixmap_matrix_scale(pixman_image_t *src, twin_matrix_t *matrix)
+static const pixman_filter_t twin_pixman_filter[3] = {
+    [TWIN_FILTER_BILINEAR] = PIXMAN_FILTER_BILINEAR,
+    [TWIN_FILTER_NEAREST] = PIXMAN_FILTER_NEAREST,
+    [TWIN_FILTER_BOX] = PIXMAN_FILTER_BILINEAR,
+};
+
+/*
+ * TWIN_FILTER_BOX mirrors the builtin box fetcher: axis-aligned downscales
+ * beyond 2x average every covered source pixel through a separable box
+ * convolution sized to the scale, anything else samples bilinearly.
+ */
+static void twin_pixman_set_filter(pixman_image_t *image,
+                                   const twin_matrix_t *m,
+                                   twin_filter_t filter)
+{
+    if (filter == TWIN_FILTER_BOX && !m->m[0][1] && !m->m[1][0] &&
+        m->m[0][0] >= TWIN_FIXED_ONE && m->m[1][1] >= TWIN_FIXED_ONE &&
+        (m->m[0][0] > 2 * TWIN_FIXED_ONE || m->m[1][1] > 2 * TWIN_FIXED_ONE)) {
+        int n_params;
+        pixman_fixed_t *params = pixman_filter_create_separable_convolution(
+            &n_params, m->m[0][0], m->m[1][1], PIXMAN_KERNEL_BOX,
+            PIXMAN_KERNEL_BOX, PIXMAN_KERNEL_BOX, PIXMAN_KERNEL_BOX, 2, 2);
+
+        if (params) {
+            pixman_image_set_filter(image, PIXMAN_FILTER_SEPARABLE_CONVOLUTION,
+                                    params, n_params);
+            /* pixman keeps its own copy; the array came from malloc */
+            free(params);
+            return;
+        }
+    }
+    pixman_image_set_filter(image, twin_pixman_filter[filter], NULL, 0);
+}
+
+static void pixmap_matrix_scale(pixman_image_t *src,
+                                const twin_matrix_t *matrix)
 {
     pixman_transform_t transform;
     pixman_transform_init_identity(&transform);
@@ -61,6 +96,219 @@ static void pixmap_matrix_scale(pixman_image_t *src, twin_matrix_t *matrix)
     pixman_image_set_transform(src, &transform);
 }
 
+/*
+ * Each pixmap on a screen lazily owns a pixman image wrapping its pixels.
+ * Bits, size, stride and format are fixed for the pixmap's lifetime, so
+ * only the transform and filter last applied to the image are tracked.
+ */
+typedef struct _twin_pixman_cache {
+    pixman_image_t *image;
+    twin_matrix_t transform;
+    twin_filter_t filter;
+} twin_pixman_cache_t;
+
+static const twin_matrix_t twin_pixman_identity = {
+    .m = {{TWIN_FIXED_ONE, 0}, {0, TWIN_FIXED_ONE}, {0, 0}},
+};
+
+static twin_pixman_cache_t *twin_pixman_cache(twin_pixmap_t *pixmap)
+{
+    twin_pixman_cache_t *cache = pixmap->image_cache;
+
+    if (cache)
+        return cache;
+    cache = twin_malloc(sizeof(twin_pixman_cache_t));
+    if (!cache)
+        return NULL;
+    cache->image = create_pixman_image_from_twin_pixmap(pixmap);
+    if (!cache->image) {
+        twin_free(cache);
+        return NULL;
+    }
+    cache->transform = twin_pixman_identity;
+    cache->filter = TWIN_FILTER_BILINEAR;
+    pixman_image_set_filter(cache->image, PIXMAN_FILTER_BILINEAR, NULL, 0);
+    pixmap->image_cache = cache;
+    return cache;
+}
+
+void twin_pixman_image_release(twin_pixmap_t *pixmap)
+{
+    twin_pixman_cache_t *cache = pixmap->image_cache;
+
+    if (!cache)
+        return;
+    pixman_image_unref(cache->image);
+    twin_free(cache);
+    pixmap->image_cache = NULL;
+}
+
+/*
+ * Pixman image for @pixmap, sampled through @matrix and @filter; the caller
+ * drops the reference it gets.  Pixmaps off screen, such as the scratch
+ * masks of twin_composite_path, get a transient image instead of a wrapper
+ * that would be allocated and freed around every composite.
+ */
+static pixman_image_t *twin_pixman_image(twin_pixmap_t *pixmap,
+                                         const twin_matrix_t *matrix,
+                                         twin_filter_t filter)
+{
+    twin_pixman_cache_t *cache = pixmap->image_cache;
+    bool refilter;
+
+    if (!cache && !pixmap->screen) {
+        pixman_image_t *image = create_pixman_image_from_twin_pixmap(pixmap);
+        twin_matrix_t m = *matrix;
+
+        if (!image)
+            return NULL;
+        if (!twin_matrix_is_identity(&m))
+            pixmap_matrix_scale(image, &m);
+        twin_pixman_set_filter(image, matrix, filter);
+        return image;
+    }
+    cache = twin_pixman_cache(pixmap);
+    if (!cache)
+        return NULL;
+    refilter = cache->filter != filter;
+    if (memcmp(&cache->transform, matrix, sizeof(twin_matrix_t))) {
+        cache->transform = *matrix;
+        if (twin_matrix_is_identity(&cache->transform))
+            pixman_image_set_transform(cache->image, NULL);
+        else
+            pixmap_matrix_scale(cache->image, &cache->transform);
+        /* The box kernel width follows the scale */
+        refilter |= filter == TWIN_FILTER_BOX;
+    }
+    if (refilter) {
+        cache->filter = filter;
+        twin_pixman_set_filter(cache->image, &cache->transform, filter);
+    }
+    return pixman_image_ref(cache->image);
+}
+
+/*
+ * Solid colours are looked up in a small direct-mapped cache; text and
+ * widget drawing reuse a handful of colours over and over. Image decoding
+ * threads composite as well, TinyVG in particular, and a slot may be
+ * replaced while its image is still in use, so each thread has its own.
+ */
+#define TWIN_PIXMAN_SOLID_BITS 4
+
+#if defined(CONFIG_LOADER_ASYNC)
+#define TWIN_PIXMAN_SOLID_LOCAL _Thread_local
+#else
+#define TWIN_PIXMAN_SOLID_LOCAL
+#endif
+
+static TWIN_PIXMAN_SOLID_LOCAL struct {
+    twin_argb32_t argb;
+    pixman_image_t *image;
+} twin_pixman_solids[1 << TWIN_PIXMAN_SOLID_BITS];
+
+static pixman_image_t *twin_pixman_solid(twin_argb32_t argb)
+{
+    uint32_t slot = (uint32_t) (argb * 2654435761u) >>
+                    (32 - TWIN_PIXMAN_SOLID_BITS);
+    pixman_image_t *image = twin_pixman_solids[slot].image;
+    pixman_color_t color;
+
+    if (image && twin_pixman_solids[slot].argb == argb)
+        return image;
+    twin_argb32_to_pixman_color(argb, &color);
+    image = pixman_image_create_solid_fill(&color);
+    if (!image)
+        return NULL;
+    if (twin_pixman_solids[slot].image)
+        pixman_image_unref(twin_pixman_solids[slot].image);
+    twin_pixman_solids[slot].argb = argb;
+    twin_pixman_solids[slot].image = image;
+    return image;
+}
+
+/*
+ * Gradients are built for each composite and released after it. Stops take
+ * straight colors, so the premultiplied ends are divided back out first.
+ */
+static void twin_pixman_stop(pixman_gradient_stop_t *stop,
+                             pixman_fixed_t x,
+                             twin_argb32_t argb)
+{
+    uint32_t a = argb >> 24;
+    twin_argb32_t straight = argb & 0xff000000;
+
+    for (int s = 0; s < 24 && a; s += 8) {
+        uint32_t c = (argb >> s) & 0xff;
+
+        straight |= (c >= a ? 0xff : (c * 255 + a / 2) / a) << s;
+    }
+    stop->x = x;
+    twin_argb32_to_pixman_color(straight, &stop->color);
+}
+
+static pixman_fixed_t twin_pixman_distance(twin_fixed_t dx, twin_fixed_t dy)
+{
+    uint64_t d2 = (int64_t) dx * dx + (int64_t) dy * dy;
+    uint64_t r = 0, bit = (uint64_t) 1 << 62;
+
+    while (bit > d2)
+        bit >>= 2;
+    for (; bit; bit >>= 2) {
+        if (d2 >= r + bit) {
+            d2 -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+    }
+    return r > INT32_MAX ? INT32_MAX : (pixman_fixed_t) r;
+}
+
+static pixman_image_t *twin_pixman_gradient(twin_source_t kind,
+                                            const twin_gradient_t *g)
+{
+    pixman_gradient_stop_t stops[2];
+    pixman_image_t *image;
+
+    twin_pixman_stop(&stops[0], pixman_int_to_fixed(0), g->color0);
+    twin_pixman_stop(&stops[1], pixman_int_to_fixed(1), g->color1);
+    if (kind == TWIN_LINEAR_GRADIENT) {
+        pixman_point_fixed_t p0 = {g->x0, g->y0}, p1 = {g->x1, g->y1};
+
+        image = pixman_image_create_linear_gradient(&p0, &p1, stops, 2);
+    } else {
+        pixman_point_fixed_t c = {g->x0, g->y0};
+
+        image = pixman_image_create_radial_gradient(
+            &c, &c, 0, twin_pixman_distance(g->x1 - g->x0, g->y1 - g->y0),
+            stops, 2);
+    }
+    if (image)
+        pixman_image_set_repeat(image, PIXMAN_REPEAT_PAD);
+    return image;
+}
+
+static pixman_image_t *twin_pixman_operand(twin_operand_t *operand,
+                                           bool transformed)
+{
+    twin_pixmap_t *pixmap;
+
+    if (operand->source_kind == TWIN_SOLID) {
+        pixman_image_t *solid = twin_pixman_solid(operand->u.argb);
+
+        return solid ? pixman_image_ref(solid) : NULL;
+    }
+    if (operand->source_kind == TWIN_LINEAR_GRADIENT ||
+        operand->source_kind == TWIN_RADIAL_GRADIENT)
+        return twin_pixman_gradient(operand->source_kind,
+                                    operand->u.gradient);
+    pixmap = operand->u.pixmap;
+    if (!transformed)
+        return twin_pixman_image(pixmap, &twin_pixman_identity,
+                                 TWIN_FILTER_BILINEAR);
+    return twin_pixman_image(pixmap, &pixmap->transform, pixmap->filter);
+}
+
 void twin_composite(twin_pixmap_t *_dst,
                     twin_coord_t dst_x,
                     twin_coord_t dst_y,
@@ -74,20 +322,18 @@ void twin_composite(twin_pixmap_t *_dst,
                     twin_coord_t width,
                     twin_coord_t height)
 {
-    pixman_image_t *src;
-    if (_src->source_kind == TWIN_SOLID) {
-        pixman_color_t source_pixel;
-        twin_argb32_to_pixman_color(_src->u.argb, &source_pixel);
-        src = pixman_image_create_solid_fill(&source_pixel);
-    } else {
-        twin_pixmap_t *src_pixmap = _src->u.pixmap;
-        src = create_pixman_image_from_twin_pixmap(src_pixmap);
-
-        if (!twin_matrix_is_identity(&(src_pixmap->transform)))
-            pixmap_matrix_scale(src, &(src_pixmap->transform));
-    }
+    /* Gradients are only defined as a source */
+    if (_msk && (_msk->source_kind == TWIN_LINEAR_GRADIENT ||
+                 _msk->source_kind == TWIN_RADIAL_GRADIENT))
+        return;
 
-    pixman_image_t *dst = create_pixman_image_from_twin_pixmap(_dst);
+    pixman_image_t *src = twin_pixman_operand(_src, true);
+    /* Masks have always been sampled untransformed by this backend */
+    pixman_image_t *msk = _msk ? twin_pixman_operand(_msk, false) : NULL;
+    pixman_image_t *dst = twin_pixman_image(_dst, &twin_pixman_identity,
+                                            TWIN_FILTER_BILINEAR);
+    if (!src || !dst || (_msk && !msk))
+        goto done;
 
     /* Set origin */
     twin_coord_t ox, oy, offset_x = 0, offset_y = 0;
@@ -109,24 +355,19 @@ void twin_composite(twin_pixmap_t *_dst,
         height = _dst->clip.bottom - oy;
 
     if (width < 0 || height < 0)
-        return;
+        goto done;
 
-    if (!_msk) {
-        pixman_image_composite(twin_to_pixman_op(operator), src, NULL, dst,
-                               src_x + offset_x, src_y + offset_y, offset_x,
-                               offset_y, ox, oy, width, height);
-    } else {
-        pixman_image_t *msk =
-            create_pixman_image_from_twin_pixmap(_msk->u.pixmap);
-        pixman_image_composite(twin_to_pixman_op(operator), src, msk, dst,
-                               src_x + offset_x, src_y + offset_y,
-                               msk_x + offset_x, msk_y + offset_y, ox, oy,
-                               width, height);
+    pixman_image_composite(twin_to_pixman_op(operator), src, msk, dst,
+                           src_x + offset_x, src_y + offset_y,
+                           msk_x + offset_x, msk_y + offset_y, ox, oy, width,
+                           height);
+done:
+    if (src)
+        pixman_image_unref(src);
+    if (msk)
         pixman_image_unref(msk);
-    }
-
-    pixman_image_unref(src);
-    pixman_image_unref(dst);
+    if (dst)
+        pixman_image_unref(dst);
 }
 
 void twin_fill(twin_pixmap_t *_dst,
@@ -155,7 +396,10 @@ void twin_fill(twin_pixmap_t *_dst,
     if (left >= right || top >= bottom)
         return;
 
-    pixman_image_t *dst = create_pixman_image_from_twin_pixmap(_dst);
+    pixman_image_t *dst = twin_pixman_image(_dst, &twin_pixman_identity,
+                                            TWIN_FILTER_BILINEAR);
+    if (!dst)
+        return;
     pixman_color_t color;
     twin_argb32_to_pixman_color(pixel, &color);
     /* clang-format off */
@@ -163,8 +407,241 @@ void twin_fill(twin_pixmap_t *_dst,
         twin_to_pixman_op(operator), dst, &color, 1,
         &(pixman_rectangle16_t) {left, top, right - left, bottom - top});
     /* clang-format on */
+    pixman_image_unref(dst);
 
     twin_pixmap_damage(_dst, left, top, right, bottom);
+}
 
-    pixman_image_unref(dst);
+#if defined(CONFIG_PIXMAN_RASTERIZER)
+/*
+ * Path rasterization through pixman.
+ *
+ * The path is swept top to bottom and cut into horizontal bands at every
+ * vertex and every edge crossing.  Inside a band the edges keep their
+ * order, so the non-zero winding spans become trapezoids that pixman
+ * accumulates into the A8 mask with its own antialiasing.
+ */
+typedef struct _twin_pixman_edge {
+    pixman_point_fixed_t p1, p2; /* top and bottom end points */
+    int winding;
+    pixman_fixed_t x0, x1, xm; /* x at the current band's top/bottom/middle */
+} twin_pixman_edge_t;
+
+typedef struct _twin_pixman_traps {
+    pixman_trapezoid_t *traps;
+    int n, size;
+} twin_pixman_traps_t;
+
+#define twin_sfixed_to_pixman(s) ((pixman_fixed_t) (s) << 12)
+
+static pixman_fixed_t _twin_pixman_edge_x(const twin_pixman_edge_t *e,
+                                          pixman_fixed_t y)
+{
+    return e->p1.x + (pixman_fixed_t) ((int64_t) (e->p2.x - e->p1.x) *
+                                       (y - e->p1.y) / (e->p2.y - e->p1.y));
+}
+
+static int _twin_pixman_edge_cmp(const void *a, const void *b)
+{
+    const twin_pixman_edge_t *ea = *(twin_pixman_edge_t *const *) a;
+    const twin_pixman_edge_t *eb = *(twin_pixman_edge_t *const *) b;
+
+    return (ea->xm > eb->xm) - (ea->xm < eb->xm);
+}
+
+static int _twin_pixman_fixed_cmp(const void *a, const void *b)
+{
+    pixman_fixed_t fa = *(const pixman_fixed_t *) a;
+    pixman_fixed_t fb = *(const pixman_fixed_t *) b;
+
+    return (fa > fb) - (fa < fb);
+}
+
+static int _twin_pixman_edge_top_cmp(const void *a, const void *b)
+{
+    const twin_pixman_edge_t *ea = a, *eb = b;
+
+    return (ea->p1.y > eb->p1.y) - (ea->p1.y < eb->p1.y);
+}
+
+/*
+ * Order @active for the band [top, bottom] and return the first y inside
+ * it where two neighbours swap, or @bottom when none do.
+ */
+static pixman_fixed_t _twin_pixman_band_split(twin_pixman_edge_t **active,
+                                              int nactive,
+                                              pixman_fixed_t top,
+                                              pixman_fixed_t bottom)
+{
+    pixman_fixed_t mid = top + (bottom - top) / 2;
+    pixman_fixed_t split = bottom;
+
+    for (int i = 0; i < nactive; i++) {
+        active[i]->x0 = _twin_pixman_edge_x(active[i], top);
+        active[i]->x1 = _twin_pixman_edge_x(active[i], bottom);
+        active[i]->xm = _twin_pixman_edge_x(active[i], mid);
+    }
+    qsort(active, nactive, sizeof(*active), _twin_pixman_edge_cmp);
+
+    for (int i = 0; i + 1 < nactive; i++) {
+        twin_pixman_edge_t *a = active[i], *b = active[i + 1];
+        int64_t da = (int64_t) a->x1 - a->x0, db = (int64_t) b->x1 - b->x0;
+        pixman_fixed_t y;
+
+        if (a->x0 <= b->x0 && a->x1 <= b->x1)
+            continue;
+        if (da == db)
+            continue;
+        y = top + (pixman_fixed_t) ((int64_t) (bottom - top) *
+                                    (b->x0 - a->x0) / (da - db));
+        if (y > top && y < split)
+            split = y;
+    }
+    return split;
+}
+
+static bool _twin_pixman_band_emit(twin_pixman_traps_t *t,
+                                   twin_pixman_edge_t **active,
+                                   int nactive,
+                                   pixman_fixed_t top,
+                                   pixman_fixed_t bottom)
+{
+    twin_pixman_edge_t *left = NULL;
+    int w = 0;
+
+    for (int i = 0; i < nactive; i++) {
+        if (!w)
+            left = active[i];
+        w += active[i]->winding;
+        if (w)
+            continue;
+
+        if (t->n == t->size) {
+            int size = t->size ? t->size * 2 : 64;
+            pixman_trapezoid_t *traps =
+                twin_realloc(t->traps, size * sizeof(pixman_trapezoid_t));
+
+            if (!traps)
+                return false;
+            t->traps = traps;
+            t->size = size;
+        }
+        t->traps[t->n++] = (pixman_trapezoid_t) {
+            .top = top,
+            .bottom = bottom,
+            .left = {left->p1, left->p2},
+            .right = {active[i]->p1, active[i]->p2},
+        };
+    }
+    return true;
+}
+
+bool twin_pixman_fill_path(twin_pixmap_t *pixmap,
+                           twin_path_t *path,
+                           twin_sfixed_t dx,
+                           twin_sfixed_t dy)
+{
+    twin_pixman_traps_t t = {NULL, 0, 0};
+    twin_pixman_edge_t *edges, **active;
+    pixman_fixed_t *ys;
+    pixman_image_t *image;
+    int nedges = 0, nys = 0, nactive = 0, next = 0, p = 0;
+    bool ok = false;
+
+    /* pixman only clips trapezoids to the image bounds */
+    if (pixmap->format != TWIN_A8 || pixmap->clip.left || pixmap->clip.top ||
+        pixmap->clip.right != pixmap->width ||
+        pixmap->clip.bottom != pixmap->height)
+        return false;
+    if (path->npoints < 3)
+        return true;
+
+    edges = twin_malloc(path->npoints * (sizeof(twin_pixman_edge_t) +
+                                         sizeof(twin_pixman_edge_t *) +
+                                         2 * sizeof(pixman_fixed_t)));
+    if (!edges)
+        return false;
+    active = (twin_pixman_edge_t **) (edges + path->npoints);
+    ys = (pixman_fixed_t *) (active + path->npoints);
+
+    for (int s = 0; s <= path->nsublen; s++) {
+        int sublen = s == path->nsublen ? path->npoints : path->sublen[s];
+
+        for (int v = p; sublen - p > 1 && v < sublen; v++) {
+            twin_spoint_t *a = &path->points[v];
+            twin_spoint_t *b = &path->points[v + 1 < sublen ? v + 1 : p];
+            twin_pixman_edge_t *e = &edges[nedges];
+
+            if (a->y == b->y)
+                continue;
+            if (a->y > b->y) {
+                twin_spoint_t *tmp = a;
+                a = b;
+                b = tmp;
+                e->winding = -1;
+            } else {
+                e->winding = 1;
+            }
+            e->p1.x = twin_sfixed_to_pixman(a->x + dx);
+            e->p1.y = twin_sfixed_to_pixman(a->y + dy);
+            e->p2.x = twin_sfixed_to_pixman(b->x + dx);
+            e->p2.y = twin_sfixed_to_pixman(b->y + dy);
+            ys[nys++] = e->p1.y;
+            ys[nys++] = e->p2.y;
+            nedges++;
+        }
+        p = sublen;
+    }
+    if (!nedges) {
+        twin_free(edges);
+        return true;
+    }
+
+    qsort(edges, nedges, sizeof(twin_pixman_edge_t),
+          _twin_pixman_edge_top_cmp);
+    qsort(ys, nys, sizeof(pixman_fixed_t), _twin_pixman_fixed_cmp);
+
+    for (int i = 0; i + 1 < nys; i++) {
+        pixman_fixed_t top = ys[i], bottom = ys[i + 1];
+
+        if (top == bottom)
+            continue;
+
+        /* retire finished edges, then add the ones starting here */
+        for (int j = 0; j < nactive;) {
+            if (active[j]->p2.y <= top)
+                active[j] = active[--nactive];
+            else
+                j++;
+        }
+        while (next < nedges && edges[next].p1.y <= top)
+            active[nactive++] = &edges[next++];
+
+        while (top < bottom) {
+            pixman_fixed_t end = bottom, split;
+
+            /* shrink the band until no two edges cross inside it */
+            while ((split = _twin_pixman_band_split(active, nactive, top,
+                                                    end)) != end)
+                end = split;
+            if (!_twin_pixman_band_emit(&t, active, nactive, top, end))
+                goto done;
+            top = end;
+        }
+    }
+
+    image = twin_pixman_image(pixmap, &twin_pixman_identity,
+                              TWIN_FILTER_BILINEAR);
+    if (!image)
+        goto done;
+    if (t.n)
+        pixman_add_trapezoids(image, 0, 0, t.n, t.traps);
+    pixman_image_unref(image);
+    ok = true;
+
+done:
+    twin_free(t.traps);
+    twin_free(edges);
+    return ok;
 }
+#endif
@@ -0,0 +1,232 @@
+/*
+ * Twin - A Tiny Window System
+ * Copyright (c) 2024 National Cheng Kung University, Taiwan
+ * All rights reserved.
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "twin_private.h"
+
+/*
+ * Binary font files
+ *
+ * tools/ttf/twin-ttf -o writes the same tables it would otherwise emit as
+ * C source, laid out so the file can be mapped and used in place:
+ *
+ *   header      twin_font_file_header_t below
+ *   name        NUL-terminated family name
+ *   style       NUL-terminated style name
+ *   charmap     n_charmap twin_charmap_t records, ascending page order
+ *   index       struct _twin_page_index: top level, then its blocks
+ *   outlines    glyph programs, as in the compiled-in fonts
+ *
+ * All fields are in the byte order of the host that wrote the file, which
+ * byte_order records; sections start on 4-byte boundaries and are located
+ * by offsets from the start of the file. The mapping is read-only and
+ * shared, so glyphs are paged in as they are first drawn and processes
+ * using the same font share its pages.
+ *
+ * The header, the section bounds and every glyph program the charmap
+ * reaches are checked on load, so drawing never reads past the mapping.
+ */
+#define TWIN_FONT_FILE_MAGIC "TWFN"
+#define TWIN_FONT_FILE_VERSION 1
+#define TWIN_FONT_FILE_BYTE_ORDER 0x0102
+
+typedef struct _twin_font_file_header {
+    char magic[4];
+    uint16_t version;
+    uint16_t byte_order;
+    uint8_t type;
+    int8_t ascender;
+    int8_t descender;
+    int8_t height;
+    uint32_t name;
+    uint32_t style;
+    uint32_t n_charmap;
+    uint32_t charmap;
+    uint32_t index;
+    uint32_t index_size;
+    uint32_t outlines;
+    uint32_t outlines_size;
+} twin_font_file_header_t;
+
+typedef struct _twin_font_file {
+    twin_font_t font; /* must be first */
+    void *map;
+    size_t size;
+} twin_font_file_t;
+
+static bool _twin_font_file_section(size_t file_size,
+                                    uint32_t offset,
+                                    size_t size)
+{
+    return offset % 4 == 0 && offset >= sizeof(twin_font_file_header_t) &&
+           offset <= file_size && size <= file_size - offset;
+}
+
+static bool _twin_font_file_string(const uint8_t *map,
+                                   size_t file_size,
+                                   uint32_t offset)
+{
+    return offset >= sizeof(twin_font_file_header_t) && offset < file_size &&
+           memchr(map + offset, '\0', file_size - offset);
+}
+
+/* Walk the glyph program at @offset the way font.c decodes it */
+static bool _twin_font_file_glyph(const signed char *outlines,
+                                  size_t size,
+                                  uint32_t offset,
+                                  uint8_t type)
+{
+    const signed char *b = outlines + offset;
+    size_t pos = offset;
+
+    if (type == TWIN_FONT_TYPE_STROKE) {
+        if (size - pos < 6 || twin_glyph_n_snap_x(b) < 0 ||
+            twin_glyph_n_snap_x(b) > TWIN_GLYPH_MAX_SNAP_X ||
+            twin_glyph_n_snap_y(b) < 0 ||
+            twin_glyph_n_snap_y(b) > TWIN_GLYPH_MAX_SNAP_Y)
+            return false;
+        pos += 6 + twin_glyph_n_snap_x(b) + twin_glyph_n_snap_y(b);
+    } else {
+        pos += 4;
+    }
+
+    for (;;) {
+        size_t args;
+
+        if (pos >= size)
+            return false;
+        switch (outlines[pos++]) {
+        case 'm':
+        case 'l':
+            args = 2;
+            break;
+        case '2':
+            args = 4;
+            break;
+        case 'c':
+            args = 6;
+            break;
+        default:
+            /* 'e', like any other op, ends the program */
+            return true;
+        }
+        if (size - pos < args)
+            return false;
+        pos += args;
+    }
+}
+
+static bool _twin_font_file_check(const uint8_t *map, size_t size)
+{
+    const twin_font_file_header_t *h = (const void *) map;
+    const struct _twin_page_index *index;
+    const twin_charmap_t *charmap;
+    size_t nblocks;
+
+    if (size < sizeof(*h) ||
+        memcmp(h->magic, TWIN_FONT_FILE_MAGIC, sizeof(h->magic)) ||
+        h->version != TWIN_FONT_FILE_VERSION ||
+        h->byte_order != TWIN_FONT_FILE_BYTE_ORDER ||
+        (h->type != TWIN_FONT_TYPE_STROKE && h->type != TWIN_FONT_TYPE_TTF))
+        return false;
+
+    if (!h->n_charmap || h->n_charmap >= UINT16_MAX ||
+        !_twin_font_file_string(map, size, h->name) ||
+        !_twin_font_file_string(map, size, h->style) ||
+        !_twin_font_file_section(size, h->charmap,
+                                 (size_t) h->n_charmap * sizeof(*charmap)) ||
+        !_twin_font_file_section(size, h->outlines, h->outlines_size) ||
+        !_twin_font_file_section(size, h->index, h->index_size) ||
+        h->index_size < sizeof(*index) ||
+        (h->index_size - sizeof(*index)) % sizeof(index->blocks[0]))
+        return false;
+
+    /* Every glyph program must lie inside the outlines */
+    charmap = (const twin_charmap_t *) (map + h->charmap);
+    for (uint32_t i = 0; i < h->n_charmap; i++)
+        for (int c = 0; c < UCS_PER_PAGE; c++)
+            if (charmap[i].offsets[c] >= h->outlines_size ||
+                !_twin_font_file_glyph(
+                    (const signed char *) map + h->outlines, h->outlines_size,
+                    charmap[i].offsets[c], h->type))
+                return false;
+
+    /* Every index slot must name a block and a charmap record */
+    index = (const struct _twin_page_index *) (map + h->index);
+    nblocks = (h->index_size - sizeof(*index)) / sizeof(index->blocks[0]);
+    for (int t = 0; t < TWIN_PAGE_BLOCKS; t++)
+        if (index->top[t] >= nblocks)
+            return false;
+    for (size_t b = 0; b < nblocks; b++)
+        for (int p = 0; p < TWIN_PAGE_BLOCK; p++)
+            if (index->blocks[b][p] > h->n_charmap)
+                return false;
+    return true;
+}
+
+twin_font_t *twin_font_load(const char *path)
+{
+    twin_font_file_t *file;
+    const twin_font_file_header_t *h;
+    struct stat st;
+    uint8_t *map;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    file = twin_malloc(sizeof(*file));
+    if (!file || !_twin_font_file_check(map, st.st_size)) {
+        twin_free(file);
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    h = (const twin_font_file_header_t *) map;
+    file->map = map;
+    file->size = st.st_size;
+    file->font = (twin_font_t){
+        .type = h->type,
+        .name = (const char *) map + h->name,
+        .style = (const char *) map + h->style,
+        .charmap = (const twin_charmap_t *) (map + h->charmap),
+        .n_charmap = h->n_charmap,
+        .outlines = (const signed char *) map + h->outlines,
+        .ascender = h->ascender,
+        .descender = h->descender,
+        .height = h->height,
+        .page_index = (struct _twin_page_index *) (map + h->index),
+    };
+    return &file->font;
+}
+
+void twin_font_destroy(twin_font_t *font)
+{
+    twin_font_file_t *file = (twin_font_file_t *) font;
+
+    if (!font)
+        return;
+    if (g_twin_font == font)
+        g_twin_font = &twin_Default_Font_Roman;
+    _twin_font_flush(font);
+    munmap(file->map, file->size);
+    twin_free(file);
+}
@@ -207,24 +207,72 @@ static twin_fixed_t _twin_snap(twin_fixed_t v, const twin_fixed_t *snap, int n)
     return v;
 }
 
-static bool twin_find_ucs4_page(twin_font_t *font, uint32_t page)
+static struct _twin_page_index *_twin_font_page_index(twin_font_t *font)
 {
+    struct _twin_page_index *index;
+    int nblocks = 1;
+
+    if (font->page_index)
+        return font->page_index;
+
+    /* One block per distinct top-level slot, counted on a scratch index */
+    uint16_t used[TWIN_PAGE_BLOCKS] = {0};
+    for (int i = 0; i < font->n_charmap; i++) {
+        unsigned int page = font->charmap[i].page;
+
+        if (page < TWIN_PAGE_MAX && !used[page >> TWIN_PAGE_BLOCK_SHIFT])
+            used[page >> TWIN_PAGE_BLOCK_SHIFT] = nblocks++;
+    }
+
+    index = twin_malloc(sizeof(*index) + nblocks * sizeof(index->blocks[0]));
+    if (!index)
+        return NULL;
+    memcpy(index->top, used, sizeof(used));
+    memset(index->blocks, 0, nblocks * sizeof(index->blocks[0]));
+
+    /* Walk backwards so the first entry for a duplicated page wins */
+    for (int i = font->n_charmap - 1; i >= 0; i--) {
+        unsigned int page = font->charmap[i].page;
+
+        if (page < TWIN_PAGE_MAX)
+            index->blocks[index->top[page >> TWIN_PAGE_BLOCK_SHIFT]]
+                         [page & (TWIN_PAGE_BLOCK - 1)] = i + 1;
+    }
+    font->page_index = index;
+    return index;
+}
+
+static const twin_charmap_t *twin_find_ucs4_page(twin_font_t *font,
+                                                 uint32_t page)
+{
+    const struct _twin_page_index *index;
+
     if (font->cur_page && font->cur_page->page == page)
-        return true;
+        return font->cur_page;
+
+    index = _twin_font_page_index(font);
+    if (index && page < TWIN_PAGE_MAX) {
+        int i = index->blocks[index->top[page >> TWIN_PAGE_BLOCK_SHIFT]]
+                             [page & (TWIN_PAGE_BLOCK - 1)];
+
+        if (!i)
+            return NULL;
+        font->cur_page = &font->charmap[i - 1];
+        return font->cur_page;
+    }
 
+    /* Out of memory, or a page beyond the Unicode code space */
     for (int i = 0; i < font->n_charmap; i++)
         if (font->charmap[i].page == page) {
             font->cur_page = &font->charmap[i];
-            return true;
+            return font->cur_page;
         }
-
-    font->cur_page = &font->charmap[0];
-    return false;
+    return NULL;
 }
 
 bool twin_has_ucs4(twin_font_t *font, twin_ucs4_t ucs4)
 {
-    return twin_find_ucs4_page(font, twin_ucs_page(ucs4));
+    return twin_find_ucs4_page(font, twin_ucs_page(ucs4)) != NULL;
 }
 
 #define SNAPX(p) _snap(path, p, snap_x, nsnap_x)
@@ -232,12 +280,14 @@ bool twin_has_ucs4(twin_font_t *font, twin_ucs4_t ucs4)
 
 static const signed char *_twin_g_base(twin_font_t *font, twin_ucs4_t ucs4)
 {
+    const twin_charmap_t *page = twin_find_ucs4_page(font, twin_ucs_page(ucs4));
     int idx = twin_ucs_char_in_page(ucs4);
 
-    if (!twin_find_ucs4_page(font, twin_ucs_page(ucs4)))
+    if (!page) {
+        page = &font->charmap[0];
         idx = 0;
-
-    return font->outlines + font->cur_page->offsets[idx];
+    }
+    return font->outlines + page->offsets[idx];
 }
 
 static twin_fixed_t _twin_glyph_width(twin_text_info_t *info,
@@ -317,7 +367,178 @@ static const signed char *twin_glyph_draw(const twin_font_t *font,
     return b + 4;
 }
 
-void twin_path_ucs4(twin_path_t *path, twin_ucs4_t ucs4)
+#if defined(CONFIG_GLYPH_CACHE) || defined(CONFIG_GLYPH_OUTLINE_CACHE)
+/*
+ * Glyph caches
+ *
+ * Two optional caches sit in front of the glyph program. The outline cache
+ * keeps the flattened, pen-convolved outline of a glyph relative to its
+ * origin, so drawing it again under the same size, style and matrix is a
+ * translated copy of its points. The coverage cache keeps the rasterized
+ * A8 mask of a glyph at a given sub-pixel phase, so painting it again is a
+ * single composite.
+ *
+ * Both are keyed on everything that shapes the outline: font, code point,
+ * size, style, cap style and the linear part of the path matrix; coverage
+ * entries add the pen phase. Entries live on an LRU list per cache whose
+ * footprint is bounded by its budget; the most recently created entry is
+ * kept even if it alone exceeds the budget.
+ */
+#define TWIN_GLYPH_CACHE_BUCKETS 64
+
+typedef struct _twin_glyph_key {
+    const twin_font_t *font;
+    twin_ucs4_t ucs4;
+    twin_fixed_t font_size;
+    twin_style_t font_style;
+    twin_cap_t cap_style;
+    twin_fixed_t linear[2][2];
+    twin_sfixed_t phase_x;
+    twin_sfixed_t phase_y;
+} twin_glyph_key_t;
+
+typedef struct _twin_glyph {
+    struct _twin_glyph *chain;    /* hash bucket chain */
+    struct _twin_glyph *lru_prev; /* towards more recently used */
+    struct _twin_glyph *lru_next; /* towards less recently used */
+    twin_glyph_key_t key;
+    uint32_t hash;
+    size_t bytes;
+    twin_sfixed_t advance_x, advance_y;
+    /* coverage cache: NULL mask for glyphs with no ink */
+    twin_pixmap_t *mask;
+    twin_coord_t left, top;
+    /* outline cache: points relative to the reference origin */
+    twin_fixed_t origin_x, origin_y;
+    twin_spoint_t *points;
+    int npoints;
+    int *sublen;
+    int nsublen;
+} twin_glyph_t;
+
+typedef struct _twin_glyph_cache {
+    twin_glyph_t *buckets[TWIN_GLYPH_CACHE_BUCKETS];
+    twin_glyph_t *lru_head, *lru_tail;
+    size_t bytes;
+    size_t budget;
+} twin_glyph_cache_t;
+
+static void _twin_glyph_key(twin_glyph_key_t *key,
+                            const twin_path_t *path,
+                            twin_ucs4_t ucs4,
+                            twin_sfixed_t phase_x,
+                            twin_sfixed_t phase_y)
+{
+    /* Keys are hashed and compared bytewise; clear the padding. */
+    memset(key, 0, sizeof(*key));
+    key->font = g_twin_font;
+    key->ucs4 = ucs4;
+    key->font_size = path->state.font_size;
+    key->font_style = path->state.font_style;
+    key->cap_style = path->state.cap_style;
+    key->linear[0][0] = path->state.matrix.m[0][0];
+    key->linear[0][1] = path->state.matrix.m[0][1];
+    key->linear[1][0] = path->state.matrix.m[1][0];
+    key->linear[1][1] = path->state.matrix.m[1][1];
+    key->phase_x = phase_x;
+    key->phase_y = phase_y;
+}
+
+static uint32_t _twin_glyph_hash(const twin_glyph_key_t *key)
+{
+    const uint8_t *p = (const uint8_t *) key;
+    uint32_t h = 2166136261u;
+
+    for (size_t i = 0; i < sizeof(*key); i++)
+        h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+static void _twin_glyph_lru_unlink(twin_glyph_cache_t *cache,
+                                   twin_glyph_t *glyph)
+{
+    if (glyph->lru_prev)
+        glyph->lru_prev->lru_next = glyph->lru_next;
+    else
+        cache->lru_head = glyph->lru_next;
+    if (glyph->lru_next)
+        glyph->lru_next->lru_prev = glyph->lru_prev;
+    else
+        cache->lru_tail = glyph->lru_prev;
+}
+
+static void _twin_glyph_lru_push(twin_glyph_cache_t *cache, twin_glyph_t *glyph)
+{
+    glyph->lru_prev = NULL;
+    glyph->lru_next = cache->lru_head;
+    if (cache->lru_head)
+        cache->lru_head->lru_prev = glyph;
+    else
+        cache->lru_tail = glyph;
+    cache->lru_head = glyph;
+}
+
+static void _twin_glyph_evict(twin_glyph_cache_t *cache, twin_glyph_t *glyph)
+{
+    twin_glyph_t **prev =
+        &cache->buckets[glyph->hash % TWIN_GLYPH_CACHE_BUCKETS];
+
+    while (*prev != glyph)
+        prev = &(*prev)->chain;
+    *prev = glyph->chain;
+    _twin_glyph_lru_unlink(cache, glyph);
+    cache->bytes -= glyph->bytes;
+    if (glyph->mask)
+        twin_pixmap_destroy(glyph->mask);
+    twin_free(glyph);
+}
+
+static twin_glyph_t *_twin_glyph_find(twin_glyph_cache_t *cache,
+                                      const twin_glyph_key_t *key,
+                                      uint32_t hash)
+{
+    for (twin_glyph_t *glyph = cache->buckets[hash % TWIN_GLYPH_CACHE_BUCKETS];
+         glyph; glyph = glyph->chain) {
+        if (glyph->hash == hash && !memcmp(&glyph->key, key, sizeof(*key))) {
+            _twin_glyph_lru_unlink(cache, glyph);
+            _twin_glyph_lru_push(cache, glyph);
+            return glyph;
+        }
+    }
+    return NULL;
+}
+
+/* @glyph->key, hash and bytes must be filled in. */
+static void _twin_glyph_insert(twin_glyph_cache_t *cache, twin_glyph_t *glyph)
+{
+    twin_glyph_t **bucket =
+        &cache->buckets[glyph->hash % TWIN_GLYPH_CACHE_BUCKETS];
+
+    while (cache->lru_tail && cache->bytes + glyph->bytes > cache->budget)
+        _twin_glyph_evict(cache, cache->lru_tail);
+
+    glyph->chain = *bucket;
+    *bucket = glyph;
+    _twin_glyph_lru_push(cache, glyph);
+    cache->bytes += glyph->bytes;
+}
+
+static void _twin_glyph_cache_flush(twin_glyph_cache_t *cache,
+                                    const twin_font_t *font)
+{
+    twin_glyph_t *glyph = cache->lru_head;
+
+    while (glyph) {
+        twin_glyph_t *next = glyph->lru_next;
+
+        if (glyph->key.font == font)
+            _twin_glyph_evict(cache, glyph);
+        glyph = next;
+    }
+}
+#endif
+
+static void _twin_path_glyph(twin_path_t *path, twin_ucs4_t ucs4)
 {
     twin_font_t *font = g_twin_font;
     const signed char *b = _twin_g_base(font, ucs4);
@@ -412,6 +633,129 @@ void twin_path_ucs4(twin_path_t *path, twin_ucs4_t ucs4)
                      origin.y + _twin_matrix_dy(&info.matrix, width, 0));
 }
 
+#if defined(CONFIG_GLYPH_OUTLINE_CACHE)
+static twin_glyph_cache_t outline_cache = {
+    .budget = (size_t) CONFIG_GLYPH_OUTLINE_CACHE_SIZE * 1024,
+};
+
+/* Trace @ucs4 at the origin of a scratch path carrying @path's state and
+ * keep a compact copy of the result. The trailing pen move is dropped;
+ * it is replayed from the advance instead.
+ */
+static twin_glyph_t *_twin_outline_create(twin_path_t *path,
+                                          twin_ucs4_t ucs4,
+                                          const twin_glyph_key_t *key,
+                                          uint32_t hash)
+{
+    twin_path_t *outline = twin_path_create();
+    twin_state_t state = twin_path_save(path);
+    twin_text_info_t info;
+    twin_glyph_t *glyph;
+    twin_spoint_t end;
+    size_t points_bytes, sublen_bytes;
+
+    if (!outline)
+        return NULL;
+    twin_path_restore(outline, &state);
+    _twin_path_smove(outline, 0, 0);
+    _twin_text_compute_info(outline, g_twin_font, &info);
+    _twin_path_glyph(outline, ucs4);
+
+    end = outline->points[--outline->npoints];
+    points_bytes = sizeof(twin_spoint_t) * outline->npoints;
+    sublen_bytes = sizeof(int) * outline->nsublen;
+    glyph = twin_malloc(sizeof(*glyph) + points_bytes + sublen_bytes);
+    if (!glyph) {
+        twin_path_destroy(outline);
+        return NULL;
+    }
+    glyph->key = *key;
+    glyph->hash = hash;
+    glyph->bytes = sizeof(*glyph) + points_bytes + sublen_bytes;
+    glyph->advance_x = end.x;
+    glyph->advance_y = end.y;
+    glyph->mask = NULL;
+    glyph->origin_x = info.matrix.m[2][0];
+    glyph->origin_y = info.matrix.m[2][1];
+    glyph->points = (twin_spoint_t *) (glyph + 1);
+    glyph->npoints = outline->npoints;
+    glyph->sublen = (int *) (glyph->points + glyph->npoints);
+    glyph->nsublen = outline->nsublen;
+    memcpy(glyph->points, outline->points, points_bytes);
+    memcpy(glyph->sublen, outline->sublen, sublen_bytes);
+    twin_path_destroy(outline);
+
+    _twin_glyph_insert(&outline_cache, glyph);
+    return glyph;
+}
+
+static bool _twin_outline_path(twin_path_t *path, twin_ucs4_t ucs4)
+{
+    twin_font_t *font = g_twin_font;
+    twin_spoint_t origin = _twin_path_current_spoint(path);
+    twin_glyph_key_t key;
+    twin_glyph_t *glyph;
+    twin_text_info_t info;
+    twin_sfixed_t dx, dy;
+    uint32_t hash;
+
+    _twin_glyph_key(&key, path, ucs4, 0, 0);
+    hash = _twin_glyph_hash(&key);
+    glyph = _twin_glyph_find(&outline_cache, &key, hash);
+    if (!glyph)
+        glyph = _twin_outline_create(path, ucs4, &key, hash);
+    if (!glyph || !_twin_path_reserve(path, glyph->npoints, glyph->nsublen + 1))
+        return false;
+
+    /*
+     * Everything but the translation of the text matrix is independent of
+     * the origin, so the difference to the reference translation (which
+     * carries any hinting snap of the origin) places the outline.
+     */
+    _twin_text_compute_info(path, font, &info);
+    dx = twin_fixed_to_sfixed(info.matrix.m[2][0] - glyph->origin_x);
+    dy = twin_fixed_to_sfixed(info.matrix.m[2][1] - glyph->origin_y);
+
+    /*
+     * Join the first point the way twin_path_ucs4() would: stroke glyphs
+     * come out of twin_path_convolve() starting with a move, outline glyphs
+     * are appended to the current subpath. The rest were deduplicated when
+     * traced and every cached subpath has more than one point, so they are
+     * copied straight into the reserved storage.
+     */
+    if (glyph->npoints) {
+        twin_sfixed_t x = glyph->points[0].x + dx;
+        twin_sfixed_t y = glyph->points[0].y + dy;
+
+        if (font->type == TWIN_FONT_TYPE_STROKE)
+            _twin_path_smove(path, x, y);
+        else
+            _twin_path_sdraw(path, x, y);
+    }
+    for (int p = 1, s = 0; p < glyph->npoints; p++) {
+        if (s < glyph->nsublen && p == glyph->sublen[s]) {
+            path->sublen[path->nsublen++] = path->npoints;
+            s++;
+        }
+        path->points[path->npoints].x = glyph->points[p].x + dx;
+        path->points[path->npoints].y = glyph->points[p].y + dy;
+        path->npoints++;
+    }
+    _twin_path_smove(path, origin.x + glyph->advance_x,
+                     origin.y + glyph->advance_y);
+    return true;
+}
+#endif
+
+void twin_path_ucs4(twin_path_t *path, twin_ucs4_t ucs4)
+{
+#if defined(CONFIG_GLYPH_OUTLINE_CACHE)
+    if (_twin_outline_path(path, ucs4))
+        return;
+#endif
+    _twin_path_glyph(path, ucs4);
+}
+
 twin_fixed_t twin_width_ucs4(twin_path_t *path, twin_ucs4_t ucs4)
 {
     twin_text_metrics_t metrics;
@@ -481,22 +825,184 @@ void twin_path_utf8(twin_path_t *path, const char *string)
     }
 }
 
-twin_fixed_t twin_width_utf8(twin_path_t *path, const char *string)
+static void _twin_paint_utf8_path(twin_pixmap_t *dst,
+                                  twin_argb32_t argb,
+                                  twin_path_t *path,
+                                  const char *string)
 {
-    int len;
+    twin_path_t *text = twin_path_create();
+    twin_state_t state = twin_path_save(path);
+    twin_spoint_t pen = _twin_path_current_spoint(path);
+
+    if (!text)
+        return;
+    twin_path_restore(text, &state);
+    _twin_path_smove(text, pen.x, pen.y);
+    twin_path_utf8(text, string);
+    twin_paint_path(dst, argb, text);
+    pen = _twin_path_current_spoint(text);
+    _twin_path_smove(path, pen.x, pen.y);
+    twin_path_destroy(text);
+}
+
+#if defined(CONFIG_GLYPH_CACHE)
+/*
+ * The pen phase is quantised to a quarter pixel. Hinted stroke glyphs snap
+ * their origin to whole pixels, so for them the phase only decides which
+ * way the snap goes and the cached mask matches the uncached rasterization
+ * bit for bit.
+ */
+#define TWIN_GLYPH_PHASE(v) ((v) & (TWIN_SFIXED_ONE - 1) & ~3)
+
+static twin_glyph_cache_t coverage_cache = {
+    .budget = (size_t) CONFIG_GLYPH_CACHE_SIZE * 1024,
+};
+
+/* Bounds of the inked subpaths, skipping the lone pen moves that bracket
+ * each glyph so they do not stretch the mask out to the baseline.
+ */
+static bool _twin_glyph_bounds(twin_path_t *path, twin_rect_t *rect)
+{
+    twin_sfixed_t left = TWIN_SFIXED_MAX, top = TWIN_SFIXED_MAX;
+    twin_sfixed_t right = TWIN_SFIXED_MIN, bottom = TWIN_SFIXED_MIN;
+
+    for (int s = 0, p = 0; s <= path->nsublen; s++) {
+        int end = s == path->nsublen ? path->npoints : path->sublen[s];
+
+        if (end - p > 1) {
+            for (; p < end; p++) {
+                if (path->points[p].x < left)
+                    left = path->points[p].x;
+                if (path->points[p].x > right)
+                    right = path->points[p].x;
+                if (path->points[p].y < top)
+                    top = path->points[p].y;
+                if (path->points[p].y > bottom)
+                    bottom = path->points[p].y;
+            }
+        }
+        p = end;
+    }
+    if (left >= right || top >= bottom)
+        return false;
+    rect->left = twin_sfixed_trunc(left);
+    rect->top = twin_sfixed_trunc(top);
+    rect->right = twin_sfixed_trunc(twin_sfixed_ceil(right));
+    rect->bottom = twin_sfixed_trunc(twin_sfixed_ceil(bottom));
+    return true;
+}
+
+static twin_glyph_t *_twin_glyph_lookup(twin_path_t *path,
+                                        twin_ucs4_t ucs4,
+                                        twin_sfixed_t phase_x,
+                                        twin_sfixed_t phase_y)
+{
+    twin_glyph_key_t key;
+    twin_glyph_t *glyph;
+    uint32_t hash;
+
+    _twin_glyph_key(&key, path, ucs4, phase_x, phase_y);
+    hash = _twin_glyph_hash(&key);
+    glyph = _twin_glyph_find(&coverage_cache, &key, hash);
+    if (glyph)
+        return glyph;
+
+    twin_path_t *outline = twin_path_create();
+    if (!outline)
+        return NULL;
+    glyph = twin_malloc(sizeof(*glyph));
+    if (!glyph) {
+        twin_path_destroy(outline);
+        return NULL;
+    }
+    glyph->key = key;
+    glyph->hash = hash;
+    glyph->bytes = sizeof(*glyph);
+    glyph->mask = NULL;
+    glyph->left = glyph->top = 0;
+
+    twin_state_t state = twin_path_save(path);
+    twin_path_restore(outline, &state);
+    _twin_path_smove(outline, phase_x, phase_y);
+    twin_path_ucs4(outline, ucs4);
+
+    twin_spoint_t end = _twin_path_current_spoint(outline);
+    glyph->advance_x = end.x - phase_x;
+    glyph->advance_y = end.y - phase_y;
+
+    twin_rect_t bounds;
+    if (_twin_glyph_bounds(outline, &bounds)) {
+        twin_coord_t width = bounds.right - bounds.left;
+        twin_coord_t height = bounds.bottom - bounds.top;
+
+        glyph->mask = twin_pixmap_create(TWIN_A8, width, height);
+        if (!glyph->mask) {
+            twin_path_destroy(outline);
+            twin_free(glyph);
+            return NULL;
+        }
+        twin_fill_path(glyph->mask, outline, -bounds.left, -bounds.top, NULL);
+        glyph->left = bounds.left;
+        glyph->top = bounds.top;
+        glyph->bytes += sizeof(twin_pixmap_t) +
+                        (size_t) glyph->mask->stride * glyph->mask->height;
+    }
+    twin_path_destroy(outline);
+
+    _twin_glyph_insert(&coverage_cache, glyph);
+    return glyph;
+}
+
+void twin_paint_utf8(twin_pixmap_t *dst,
+                     twin_argb32_t argb,
+                     twin_path_t *path,
+                     const char *string)
+{
+    twin_operand_t src = {.source_kind = TWIN_SOLID, .u.argb = argb};
+    twin_spoint_t pen = _twin_path_current_spoint(path);
     twin_ucs4_t ucs4;
-    twin_fixed_t w = 0;
+    int len;
 
     while ((len = _twin_utf8_to_ucs4(string, &ucs4)) > 0) {
-        w += twin_width_ucs4(path, ucs4);
+        twin_sfixed_t phase_x = TWIN_GLYPH_PHASE(pen.x);
+        twin_sfixed_t phase_y = TWIN_GLYPH_PHASE(pen.y);
+        twin_glyph_t *glyph = _twin_glyph_lookup(path, ucs4, phase_x, phase_y);
+
+        if (!glyph) {
+            /* Out of memory: rasterize the rest of the run directly. */
+            _twin_path_smove(path, pen.x, pen.y);
+            _twin_paint_utf8_path(dst, argb, path, string);
+            return;
+        }
+        if (glyph->mask) {
+            twin_operand_t msk = {.source_kind = TWIN_PIXMAP,
+                                  .u.pixmap = glyph->mask};
+
+            twin_composite(dst, twin_sfixed_trunc(pen.x) + glyph->left,
+                           twin_sfixed_trunc(pen.y) + glyph->top, &src, 0, 0,
+                           &msk, 0, 0, TWIN_OVER, glyph->mask->width,
+                           glyph->mask->height);
+        }
+        pen.x += glyph->advance_x;
+        pen.y += glyph->advance_y;
         string += len;
     }
-    return w;
+    _twin_path_smove(path, pen.x, pen.y);
 }
+#else
+void twin_paint_utf8(twin_pixmap_t *dst,
+                     twin_argb32_t argb,
+                     twin_path_t *path,
+                     const char *string)
+{
+    _twin_paint_utf8_path(dst, argb, path, string);
+}
+#endif
 
-void twin_text_metrics_utf8(twin_path_t *path,
-                            const char *string,
-                            twin_text_metrics_t *m)
+/* Measure @string, filling @m and returning its advance width */
+static twin_fixed_t _twin_text_measure_utf8(twin_path_t *path,
+                                            const char *string,
+                                            twin_text_metrics_t *m)
 {
     int len;
     twin_ucs4_t ucs4;
@@ -528,4 +1034,125 @@ void twin_text_metrics_utf8(twin_path_t *path,
         w = c.width;
         string += len;
     }
+    return w;
+}
+
+#if defined(CONFIG_TEXT_METRICS_CACHE)
+/*
+ * Text run cache
+ *
+ * Widgets measure the same strings on every geometry query and again on
+ * every paint. Measured runs are kept in a small direct-mapped table keyed
+ * on the string and the path state metrics depend on: font, size, style
+ * and the linear part of the matrix, which drives hinting. A run hashing
+ * to an occupied slot replaces it; strings longer than TWIN_TEXT_RUN_MAX
+ * bytes are measured directly.
+ */
+#define TWIN_TEXT_RUN_SLOTS 32
+#define TWIN_TEXT_RUN_MAX 63
+
+typedef struct _twin_text_run {
+    const twin_font_t *font;
+    twin_fixed_t font_size;
+    twin_style_t font_style;
+    twin_fixed_t linear[2][2];
+    uint32_t hash;
+    twin_fixed_t width;
+    twin_text_metrics_t metrics;
+    char string[TWIN_TEXT_RUN_MAX + 1];
+} twin_text_run_t;
+
+static twin_text_run_t text_runs[TWIN_TEXT_RUN_SLOTS];
+
+static bool _twin_text_run_match(const twin_text_run_t *run,
+                                 const twin_path_t *path,
+                                 uint32_t hash,
+                                 const char *string,
+                                 size_t len)
+{
+    const twin_matrix_t *matrix = &path->state.matrix;
+
+    return run->font == g_twin_font && run->hash == hash &&
+           run->font_size == path->state.font_size &&
+           run->font_style == path->state.font_style &&
+           run->linear[0][0] == matrix->m[0][0] &&
+           run->linear[0][1] == matrix->m[0][1] &&
+           run->linear[1][0] == matrix->m[1][0] &&
+           run->linear[1][1] == matrix->m[1][1] &&
+           !memcmp(run->string, string, len + 1);
+}
+
+static twin_fixed_t _twin_text_run_measure(twin_path_t *path,
+                                           const char *string,
+                                           twin_text_metrics_t *m)
+{
+    const twin_matrix_t *matrix = &path->state.matrix;
+    uint32_t hash = 2166136261u;
+    twin_text_run_t *run;
+    size_t len;
+
+    for (len = 0; string[len] && len <= TWIN_TEXT_RUN_MAX; len++)
+        hash = (hash ^ (uint8_t) string[len]) * 16777619u;
+    if (!len || string[len])
+        return _twin_text_measure_utf8(path, string, m);
+
+    run = &text_runs[(hash ^ (uint32_t) path->state.font_size) %
+                     TWIN_TEXT_RUN_SLOTS];
+    if (_twin_text_run_match(run, path, hash, string, len)) {
+        /* Measuring gives an empty path its origin; keep that on a hit */
+        _twin_path_current_spoint(path);
+        *m = run->metrics;
+        return run->width;
+    }
+
+    run->width = _twin_text_measure_utf8(path, string, &run->metrics);
+    run->font = g_twin_font;
+    run->font_size = path->state.font_size;
+    run->font_style = path->state.font_style;
+    run->linear[0][0] = matrix->m[0][0];
+    run->linear[0][1] = matrix->m[0][1];
+    run->linear[1][0] = matrix->m[1][0];
+    run->linear[1][1] = matrix->m[1][1];
+    run->hash = hash;
+    memcpy(run->string, string, len + 1);
+    *m = run->metrics;
+    return run->width;
+}
+#else
+static twin_fixed_t _twin_text_run_measure(twin_path_t *path,
+                                           const char *string,
+                                           twin_text_metrics_t *m)
+{
+    return _twin_text_measure_utf8(path, string, m);
+}
+#endif
+
+twin_fixed_t twin_width_utf8(twin_path_t *path, const char *string)
+{
+    twin_text_metrics_t m;
+
+    return _twin_text_run_measure(path, string, &m);
+}
+
+void twin_text_metrics_utf8(twin_path_t *path,
+                            const char *string,
+                            twin_text_metrics_t *m)
+{
+    _twin_text_run_measure(path, string, m);
+}
+
+void _twin_font_flush(const twin_font_t *font)
+{
+#if defined(CONFIG_GLYPH_OUTLINE_CACHE)
+    _twin_glyph_cache_flush(&outline_cache, font);
+#endif
+#if defined(CONFIG_GLYPH_CACHE)
+    _twin_glyph_cache_flush(&coverage_cache, font);
+#endif
+#if defined(CONFIG_TEXT_METRICS_CACHE)
+    for (int i = 0; i < TWIN_TEXT_RUN_SLOTS; i++)
+        if (text_runs[i].font == font)
+            text_runs[i].font = NULL;
+#endif
+    (void) font;
 }
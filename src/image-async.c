@@ -0,0 +1,239 @@
+/*
+ * Twin - A Tiny Window System
+ * Copyright (c) 2026 National Cheng Kung University, Taiwan
+ * All rights reserved.
+ */
+
+#include <string.h>
+
+#if defined(CONFIG_LOADER_ASYNC)
+#include <pthread.h>
+#endif
+
+#include "twin_private.h"
+
+/*
+ * Background image loading
+ *
+ * Requests are queued by the UI thread and taken by a small pool of
+ * decoding threads, which hand the results back through a second queue.
+ * A single work item drains that queue, so callbacks run from the
+ * dispatch loop like any other work. When threads are unavailable the
+ * same work item decodes one pending request per dispatch iteration.
+ *
+ * Loaders mostly build just the pixmap they return. The state they share
+ * with the UI thread is the allocator, which is locked when
+ * CONFIG_LOADER_ASYNC is enabled, and the Pixman renderer's solid colour
+ * cache, which is then kept per thread.
+ */
+
+struct _twin_image_load {
+    twin_image_load_t *next;
+    char *path;
+    twin_format_t fmt;
+    twin_image_callback_t callback;
+    void *closure;
+    twin_pixmap_t *pixmap;
+    bool cancelled;
+};
+
+typedef struct {
+    twin_image_load_t *head, *tail;
+} twin_image_load_queue_t;
+
+static struct {
+    twin_image_load_queue_t pending; /* waiting for a decoder */
+    twin_image_load_queue_t done;    /* waiting for delivery */
+    int outstanding;                 /* requests not yet delivered */
+    twin_work_t *work;
+#if defined(CONFIG_LOADER_ASYNC)
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    int threads;
+#endif
+} loads = {
+#if defined(CONFIG_LOADER_ASYNC)
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+#endif
+};
+
+#if defined(CONFIG_LOADER_ASYNC)
+#define LOADS_LOCK() pthread_mutex_lock(&loads.lock)
+#define LOADS_UNLOCK() pthread_mutex_unlock(&loads.lock)
+#define LOADS_THREADS() loads.threads
+#else
+#define LOADS_LOCK() ((void) 0)
+#define LOADS_UNLOCK() ((void) 0)
+#define LOADS_THREADS() 0
+#endif
+
+static void _twin_image_load_push(twin_image_load_queue_t *q,
+                                  twin_image_load_t *load)
+{
+    load->next = NULL;
+    if (q->head)
+        q->tail->next = load;
+    else
+        q->head = load;
+    q->tail = load;
+}
+
+static twin_image_load_t *_twin_image_load_pop(twin_image_load_queue_t *q)
+{
+    twin_image_load_t *load = q->head;
+
+    if (load)
+        q->head = load->next;
+    return load;
+}
+
+static bool _twin_image_load_remove(twin_image_load_queue_t *q,
+                                    twin_image_load_t *load)
+{
+    twin_image_load_t **prev, *prev_load = NULL;
+
+    for (prev = &q->head; *prev; prev = &(*prev)->next) {
+        if (*prev == load) {
+            *prev = load->next;
+            if (q->tail == load)
+                q->tail = prev_load;
+            return true;
+        }
+        prev_load = *prev;
+    }
+    return false;
+}
+
+#if defined(CONFIG_LOADER_ASYNC)
+static void *_twin_image_load_thread(void *arg)
+{
+    (void) arg;
+
+    pthread_mutex_lock(&loads.lock);
+    for (;;) {
+        twin_image_load_t *load = _twin_image_load_pop(&loads.pending);
+
+        if (!load) {
+            pthread_cond_wait(&loads.wake, &loads.lock);
+            continue;
+        }
+        pthread_mutex_unlock(&loads.lock);
+        load->pixmap = twin_pixmap_from_file(load->path, load->fmt);
+        pthread_mutex_lock(&loads.lock);
+        _twin_image_load_push(&loads.done, load);
+    }
+    return NULL;
+}
+
+/* Threads start with the first request and then wait for more */
+static void _twin_image_load_start(void)
+{
+    static bool started;
+
+    if (started)
+        return;
+    started = true;
+    for (int i = 0; i < CONFIG_LOADER_ASYNC_THREADS; i++) {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, _twin_image_load_thread, NULL))
+            break;
+        pthread_detach(thread);
+        loads.threads++;
+    }
+    if (!loads.threads)
+        log_warn("No image decoding threads, loading on the UI thread");
+}
+#endif
+
+static bool _twin_image_load_deliver(void *closure)
+{
+    twin_image_load_t *load, *done;
+
+    (void) closure;
+
+    if (!LOADS_THREADS() && (load = _twin_image_load_pop(&loads.pending))) {
+        load->pixmap = twin_pixmap_from_file(load->path, load->fmt);
+        _twin_image_load_push(&loads.done, load);
+    }
+
+    LOADS_LOCK();
+    done = loads.done.head;
+    loads.done.head = NULL;
+    LOADS_UNLOCK();
+
+    while ((load = done)) {
+        done = load->next;
+        loads.outstanding--;
+        if (!load->cancelled)
+            load->callback(load->pixmap, load->closure);
+        else if (load->pixmap)
+            twin_pixmap_destroy(load->pixmap);
+        twin_free(load->path);
+        twin_free(load);
+    }
+
+    if (loads.outstanding)
+        return true;
+    loads.work = NULL;
+    return false;
+}
+
+twin_image_load_t *twin_pixmap_from_file_async(const char *path,
+                                               twin_format_t fmt,
+                                               twin_image_callback_t callback,
+                                               void *closure)
+{
+    twin_image_load_t *load;
+    size_t len;
+
+    if (!path || !callback)
+        return NULL;
+
+    len = strlen(path) + 1;
+    load = twin_calloc(1, sizeof(*load));
+    if (!load || !(load->path = twin_malloc(len))) {
+        twin_free(load);
+        return NULL;
+    }
+    memcpy(load->path, path, len);
+    load->fmt = fmt;
+    load->callback = callback;
+    load->closure = closure;
+
+    if (!loads.work) {
+        loads.work =
+            twin_set_work(_twin_image_load_deliver, TWIN_WORK_LAYOUT, &loads);
+        if (!loads.work) {
+            twin_free(load->path);
+            twin_free(load);
+            return NULL;
+        }
+    }
+#if defined(CONFIG_LOADER_ASYNC)
+    _twin_image_load_start();
+#endif
+    loads.outstanding++;
+
+    LOADS_LOCK();
+    _twin_image_load_push(&loads.pending, load);
+#if defined(CONFIG_LOADER_ASYNC)
+    pthread_cond_signal(&loads.wake);
+#endif
+    LOADS_UNLOCK();
+    return load;
+}
+
+void twin_pixmap_load_cancel(twin_image_load_t *load)
+{
+    if (!load)
+        return;
+
+    LOADS_LOCK();
+    load->cancelled = true;
+    /* Not started yet: skip the decode and just release it */
+    if (_twin_image_load_remove(&loads.pending, load))
+        _twin_image_load_push(&loads.done, load);
+    LOADS_UNLOCK();
+}
@@ -0,0 +1,282 @@
+/*
+ * Twin - A Tiny Window System
+ * Copyright (c) 2026 National Cheng Kung University, Taiwan
+ * All rights reserved.
+ */
+
+#include <string.h>
+#include <sys/stat.h>
+
+#include "twin_private.h"
+
+#if defined(CONFIG_IMAGE_CACHE)
+/*
+ * Decoded image cache
+ *
+ * Images are keyed on path, format and bounding box, and remembered with
+ * the file's modification time, size and inode; a lookup that finds the
+ * file changed decodes it again, and the old entry leaves the table but
+ * stays with its holders until they release it. Callers share one pixmap
+ * per key and hold a reference on it until twin_image_cache_release().
+ *
+ * Every entry sits on an LRU list. When the pixels held exceed the budget,
+ * unreferenced entries are dropped from the least recently used end;
+ * referenced ones stay, so the budget can be exceeded while they are in
+ * use. Animated images are not shared, since playback state lives in the
+ * pixmap, and are handed out uncached.
+ *
+ * The cache belongs to the thread running the dispatch loop.
+ */
+#define TWIN_IMAGE_CACHE_BUCKETS 64
+
+typedef struct _twin_image_entry {
+    struct _twin_image_entry *chain;    /* hash bucket chain */
+    struct _twin_image_entry *lru_prev; /* towards more recently used */
+    struct _twin_image_entry *lru_next; /* towards less recently used */
+    uint32_t hash;
+    twin_format_t fmt;
+    twin_coord_t max_w, max_h;
+    time_t mtime;
+    off_t size;
+    ino_t ino;
+    twin_pixmap_t *pixmap;
+    size_t bytes;
+    int refs;
+    bool stale; /* out of the table; freed on its last release */
+    char path[];
+} twin_image_entry_t;
+
+static struct {
+    twin_image_entry_t *buckets[TWIN_IMAGE_CACHE_BUCKETS];
+    twin_image_entry_t *lru_head, *lru_tail;
+    twin_image_cache_stats_t stats;
+} cache = {
+    .stats.budget = CONFIG_IMAGE_CACHE_SIZE * 1024,
+};
+
+static uint32_t _twin_image_cache_hash(const char *path,
+                                       twin_format_t fmt,
+                                       twin_coord_t max_w,
+                                       twin_coord_t max_h)
+{
+    uint32_t h = 2166136261u;
+
+    while (*path)
+        h = (h ^ (uint8_t) *path++) * 16777619u;
+    h = (h ^ fmt) * 16777619u;
+    h = (h ^ (uint16_t) max_w) * 16777619u;
+    return (h ^ (uint16_t) max_h) * 16777619u;
+}
+
+static void _twin_image_cache_lru_unlink(twin_image_entry_t *entry)
+{
+    if (entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        cache.lru_head = entry->lru_next;
+    if (entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        cache.lru_tail = entry->lru_prev;
+    entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void _twin_image_cache_lru_push(twin_image_entry_t *entry)
+{
+    entry->lru_next = cache.lru_head;
+    if (cache.lru_head)
+        cache.lru_head->lru_prev = entry;
+    else
+        cache.lru_tail = entry;
+    cache.lru_head = entry;
+}
+
+/* Take @entry out of the table so later lookups no longer find it. */
+static void _twin_image_cache_detach(twin_image_entry_t *entry)
+{
+    twin_image_entry_t **prev =
+        &cache.buckets[entry->hash % TWIN_IMAGE_CACHE_BUCKETS];
+
+    while (*prev != entry)
+        prev = &(*prev)->chain;
+    *prev = entry->chain;
+    entry->stale = true;
+    cache.stats.entries--;
+}
+
+static void _twin_image_cache_free(twin_image_entry_t *entry)
+{
+    if (!entry->stale)
+        _twin_image_cache_detach(entry);
+    _twin_image_cache_lru_unlink(entry);
+    cache.stats.bytes -= entry->bytes;
+    twin_pixmap_destroy(entry->pixmap);
+    twin_free(entry);
+}
+
+static void _twin_image_cache_trim(void)
+{
+    twin_image_entry_t *entry = cache.lru_tail;
+
+    while (entry && cache.stats.bytes > cache.stats.budget) {
+        twin_image_entry_t *prev = entry->lru_prev;
+
+        if (!entry->refs) {
+            _twin_image_cache_free(entry);
+            cache.stats.evictions++;
+        }
+        entry = prev;
+    }
+}
+
+static twin_image_entry_t *_twin_image_cache_find(twin_pixmap_t *pixmap)
+{
+    for (twin_image_entry_t *entry = cache.lru_head; entry;
+         entry = entry->lru_next)
+        if (entry->pixmap == pixmap)
+            return entry;
+    return NULL;
+}
+
+twin_pixmap_t *twin_image_cache_get(const char *path,
+                                    twin_format_t fmt,
+                                    twin_coord_t max_w,
+                                    twin_coord_t max_h)
+{
+    twin_image_entry_t *entry;
+    twin_pixmap_t *pixmap;
+    struct stat st;
+    uint32_t hash;
+    size_t len;
+
+    if (!path || stat(path, &st) < 0)
+        return NULL;
+
+    hash = _twin_image_cache_hash(path, fmt, max_w, max_h);
+    for (entry = cache.buckets[hash % TWIN_IMAGE_CACHE_BUCKETS]; entry;
+         entry = entry->chain) {
+        if (entry->hash != hash || entry->fmt != fmt ||
+            entry->max_w != max_w || entry->max_h != max_h ||
+            strcmp(entry->path, path))
+            continue;
+        if (entry->mtime == st.st_mtime && entry->size == st.st_size &&
+            entry->ino == st.st_ino) {
+            _twin_image_cache_lru_unlink(entry);
+            _twin_image_cache_lru_push(entry);
+            entry->refs++;
+            cache.stats.hits++;
+            return entry->pixmap;
+        }
+        if (entry->refs)
+            _twin_image_cache_detach(entry);
+        else
+            _twin_image_cache_free(entry);
+        break;
+    }
+
+    cache.stats.misses++;
+    pixmap = twin_pixmap_from_file_scaled(path, fmt, max_w, max_h);
+    if (!pixmap || pixmap->animation)
+        return pixmap;
+
+    len = strlen(path) + 1;
+    entry = twin_calloc(1, sizeof(*entry) + len);
+    if (!entry)
+        return pixmap;
+    memcpy(entry->path, path, len);
+    entry->hash = hash;
+    entry->fmt = fmt;
+    entry->max_w = max_w;
+    entry->max_h = max_h;
+    entry->mtime = st.st_mtime;
+    entry->size = st.st_size;
+    entry->ino = st.st_ino;
+    entry->pixmap = pixmap;
+    entry->bytes = sizeof(*pixmap) + (size_t) pixmap->stride * pixmap->height;
+    entry->refs = 1;
+    entry->chain = cache.buckets[hash % TWIN_IMAGE_CACHE_BUCKETS];
+    cache.buckets[hash % TWIN_IMAGE_CACHE_BUCKETS] = entry;
+    _twin_image_cache_lru_push(entry);
+    cache.stats.entries++;
+    cache.stats.bytes += entry->bytes;
+    _twin_image_cache_trim();
+    return pixmap;
+}
+
+void twin_image_cache_release(twin_pixmap_t *pixmap)
+{
+    twin_image_entry_t *entry;
+
+    if (!pixmap)
+        return;
+
+    entry = _twin_image_cache_find(pixmap);
+    if (!entry) {
+        /* Animated, or decoded when no entry could be allocated */
+        if (pixmap->animation)
+            twin_animation_destroy(pixmap->animation);
+        twin_pixmap_destroy(pixmap);
+        return;
+    }
+    if (--entry->refs)
+        return;
+    if (entry->stale)
+        _twin_image_cache_free(entry);
+    else
+        _twin_image_cache_trim();
+}
+
+void twin_image_cache_set_budget(size_t bytes)
+{
+    cache.stats.budget = bytes;
+    _twin_image_cache_trim();
+}
+
+void twin_image_cache_flush(void)
+{
+    size_t budget = cache.stats.budget;
+
+    cache.stats.budget = 0;
+    _twin_image_cache_trim();
+    cache.stats.budget = budget;
+}
+
+void twin_image_cache_get_stats(twin_image_cache_stats_t *stats)
+{
+    if (stats)
+        *stats = cache.stats;
+}
+
+#else /* !CONFIG_IMAGE_CACHE */
+
+twin_pixmap_t *twin_image_cache_get(const char *path,
+                                    twin_format_t fmt,
+                                    twin_coord_t max_w,
+                                    twin_coord_t max_h)
+{
+    return twin_pixmap_from_file_scaled(path, fmt, max_w, max_h);
+}
+
+void twin_image_cache_release(twin_pixmap_t *pixmap)
+{
+    if (!pixmap)
+        return;
+    if (pixmap->animation)
+        twin_animation_destroy(pixmap->animation);
+    twin_pixmap_destroy(pixmap);
+}
+
+void twin_image_cache_set_budget(size_t bytes)
+{
+    (void) bytes;
+}
+
+void twin_image_cache_flush(void) {}
+
+void twin_image_cache_get_stats(twin_image_cache_stats_t *stats)
+{
+    if (stats)
+        memset(stats, 0, sizeof(*stats));
+}
+
+#endif /* CONFIG_IMAGE_CACHE */
@@ -8,10 +8,8 @@
  * https://github.com/lecram/gifdec
  */
 
-#include <fcntl.h>
 #include <stdint.h>
 #include <stdlib.h>
-#include <unistd.h>
 
 #include "twin.h"
 #include "twin_private.h"
@@ -29,9 +27,16 @@ typedef struct {
     int transparency;
 } gif_gce_t;
 
+/*
+ * The whole file is mapped (or, where mmap is unavailable, read in one go)
+ * and parsed from memory; reads past the end yield zeros and leave pos at
+ * size, so a truncated stream ends in an empty frame rather than garbage.
+ */
 typedef struct _twin_gif {
-    int fd;
-    off_t anim_start;
+    const uint8_t *data;
+    size_t size, pos;
+    bool mapped;
+    size_t anim_start;
     twin_coord_t width, height;
     twin_coord_t depth;
     twin_count_t loop_count;
@@ -58,47 +63,98 @@ typedef struct {
     entry_t *entries;
 } table_t;
 
-static uint16_t read_num(int fd)
+/* LZW code stream: sub-block payloads feeding a 64-bit accumulator */
+typedef struct {
+    const uint8_t *p, *block_end, *end;
+    uint64_t bits;
+    int nbits;
+} gif_bits_t;
+
+static bool gif_eof(const twin_gif_t *gif)
+{
+    return gif->pos >= gif->size;
+}
+
+static uint8_t read_byte(twin_gif_t *gif)
+{
+    if (gif_eof(gif))
+        return 0;
+    return gif->data[gif->pos++];
+}
+
+static void read_bytes(twin_gif_t *gif, void *dst, size_t n)
+{
+    size_t avail = gif->size - gif->pos;
+
+    if (n > avail) {
+        memset((uint8_t *) dst + avail, 0, n - avail);
+        n = avail;
+    }
+    memcpy(dst, gif->data + gif->pos, n);
+    gif->pos += n;
+}
+
+static void skip_bytes(twin_gif_t *gif, size_t n)
+{
+    gif->pos += MIN(n, gif->size - gif->pos);
+}
+
+static uint16_t read_num(twin_gif_t *gif)
 {
     uint8_t bytes[2];
 
-    read(fd, bytes, 2);
+    read_bytes(gif, bytes, 2);
     return bytes[0] + (((uint16_t) bytes[1]) << 8);
 }
 
+/* Rewind to the first frame, over a canvas cleared to the background. */
+static void gif_reset(twin_gif_t *gif)
+{
+    const uint8_t *bgcolor = &gif->gct.colors[gif->bgindex * 3];
+
+    gif->pos = gif->anim_start;
+    memset(&gif->gce, 0, sizeof(gif->gce));
+    gif->palette = &gif->gct;
+    gif->fw = gif->fh = 0;
+    memset(gif->frame, gif->bgindex, gif->width * gif->height);
+    for (int i = 0; i < gif->width * gif->height; i++)
+        memcpy(&gif->canvas[i * 3], bgcolor, 3);
+}
+
 static twin_gif_t *gif_open(const char *fname)
 {
     uint8_t sigver[3];
     uint16_t width, height, depth;
-    uint8_t fdsz, bgidx, aspect;
-    int i;
-    uint8_t *bgcolor;
+    uint8_t fdsz;
     int gct_sz;
     twin_gif_t *gif;
 
-    int fd = open(fname, O_RDONLY);
-    if (fd == -1)
+    /* Create twin_gif_t Structure. */
+    gif = twin_calloc(1, sizeof(*gif));
+    if (!gif)
+        return NULL;
+    gif->data = _twin_file_map(fname, &gif->size, &gif->mapped);
+    if (!gif->data) {
+        twin_free(gif);
         return NULL;
-#ifdef _WIN32
-    setmode(fd, O_BINARY);
-#endif
+    }
     /* Header */
-    read(fd, sigver, 3);
+    read_bytes(gif, sigver, 3);
     if (memcmp(sigver, "GIF", 3) != 0) {
         log_error("Invalid signature");
         goto fail;
     }
     /* Version */
-    read(fd, sigver, 3);
+    read_bytes(gif, sigver, 3);
     if (memcmp(sigver, "89a", 3) != 0) {
         log_error("Invalid version");
         goto fail;
     }
     /* Width x Height */
-    width = read_num(fd);
-    height = read_num(fd);
+    width = read_num(gif);
+    height = read_num(gif);
     /* FDSZ */
-    read(fd, &fdsz, 1);
+    fdsz = read_byte(gif);
     /* Presence of GCT */
     if (!(fdsz & 0x80)) {
         log_error("No global color table");
@@ -110,41 +166,26 @@ static twin_gif_t *gif_open(const char *fname)
     /* GCT Size */
     gct_sz = 1 << ((fdsz & 0x07) + 1);
     /* Background Color Index */
-    read(fd, &bgidx, 1);
+    gif->bgindex = read_byte(gif);
     /* Aspect Ratio */
-    read(fd, &aspect, 1);
-    /* Create twin_gif_t Structure. */
-    gif = twin_calloc(1, sizeof(*gif));
-    if (!gif)
-        goto fail;
-    gif->fd = fd;
+    skip_bytes(gif, 1);
     gif->width = width;
     gif->height = height;
     gif->depth = depth;
     /* Read GCT */
     gif->gct.size = gct_sz;
-    read(fd, gif->gct.colors, 3 * gif->gct.size);
-    gif->palette = &gif->gct;
-    gif->bgindex = bgidx;
-    gif->frame = twin_calloc(4, width * height);
-    if (!gif->frame) {
-        twin_free(gif);
+    read_bytes(gif, gif->gct.colors, 3 * gif->gct.size);
+    gif->frame = twin_malloc(4 * width * height);
+    if (!gif->frame)
         goto fail;
-    }
     gif->canvas = &gif->frame[width * height];
-    if (gif->bgindex)
-        memset(gif->frame, gif->bgindex, gif->width * gif->height);
-    bgcolor = &gif->palette->colors[gif->bgindex * 3];
-    if (bgcolor[0] || bgcolor[1] || bgcolor[2])
-        for (i = 0; i < gif->width * gif->height; i++)
-            memcpy(&gif->canvas[i * 3], bgcolor, 3);
-    gif->anim_start = lseek(fd, 0, SEEK_CUR);
-    goto ok;
+    gif->anim_start = gif->pos;
+    gif_reset(gif);
+    return gif;
 fail:
-    close(fd);
+    _twin_file_unmap(gif->data, gif->size, gif->mapped);
+    twin_free(gif);
     return NULL;
-ok:
-    return gif;
 }
 
 static void discard_sub_blocks(twin_gif_t *gif)
@@ -152,8 +193,8 @@ static void discard_sub_blocks(twin_gif_t *gif)
     uint8_t size;
 
     do {
-        read(gif->fd, &size, 1);
-        lseek(gif->fd, size, SEEK_CUR);
+        size = read_byte(gif);
+        skip_bytes(gif, size);
     } while (size);
 }
 
@@ -203,36 +244,46 @@ static int entry_add(table_t **table_p,
     return 0;
 }
 
-static uint16_t get_key(twin_gif_t *gif,
-                        int key_size,
-                        uint8_t *sub_len,
-                        uint8_t *shift,
-                        uint8_t *byte)
+static void bits_init(gif_bits_t *br, const uint8_t *start, const uint8_t *end)
 {
-    int bits_read;
-    int rpad;
-    int frag_size;
-    uint16_t key;
+    br->p = br->block_end = start;
+    br->end = end;
+    br->bits = 0;
+    br->nbits = 0;
+}
 
-    key = 0;
-    for (bits_read = 0; bits_read < key_size; bits_read += frag_size) {
-        rpad = (*shift + bits_read) % 8;
-        if (rpad == 0) {
-            /* Update byte. */
-            if (*sub_len == 0) {
-                read(gif->fd, sub_len, 1); /* Must be nonzero! */
-                if (*sub_len == 0)
-                    return 0x1000;
-            }
-            read(gif->fd, byte, 1);
-            (*sub_len)--;
+/* Top the accumulator up to at least 57 bits, crossing sub-blocks. */
+static void bits_refill(gif_bits_t *br)
+{
+    while (br->nbits <= 56) {
+        if (br->p == br->block_end) {
+            /* Next sub-block; a zero length terminates the stream. */
+            if (br->p >= br->end || !*br->p)
+                return;
+            br->block_end = MIN(br->p + 1 + *br->p, br->end);
+            br->p++;
+            continue;
         }
-        frag_size = MIN(key_size - bits_read, 8 - rpad);
-        key |= ((uint16_t) ((*byte) >> rpad)) << bits_read;
+        size_t n = MIN((size_t) (br->block_end - br->p),
+                       (size_t) (64 - br->nbits) >> 3);
+        for (size_t i = 0; i < n; i++, br->nbits += 8)
+            br->bits |= (uint64_t) *br->p++ << br->nbits;
     }
-    /* Clear extra bits to the left. */
-    key &= (1 << key_size) - 1;
-    *shift = (*shift + key_size) % 8;
+}
+
+/* Next key_size-bit code, or 0x1000 once the data sub-blocks run out. */
+static uint16_t get_key(gif_bits_t *br, int key_size)
+{
+    uint16_t key;
+
+    if (br->nbits < key_size) {
+        bits_refill(br);
+        if (br->nbits < key_size)
+            return 0x1000;
+    }
+    key = br->bits & ((1 << key_size) - 1);
+    br->bits >>= key_size;
+    br->nbits -= key_size;
     return key;
 }
 
@@ -262,7 +313,7 @@ static int interlaced_line_index(int h, int y)
  */
 static int read_image_data(twin_gif_t *gif, int interlace)
 {
-    uint8_t sub_len, shift, byte;
+    gif_bits_t br;
     int init_key_size, key_size;
     bool is_table_full = false;
     int frm_off, frm_size, str_len = 0, i, p, x, y;
@@ -270,24 +321,22 @@ static int read_image_data(twin_gif_t *gif, int interlace)
     int ret;
     table_t *table;
     entry_t entry = {0};
-    off_t start, end;
+    size_t start;
 
-    read(gif->fd, &byte, 1);
-    key_size = (int) byte;
+    key_size = (int) read_byte(gif);
     if (key_size < 2 || key_size > 8)
         return -1;
 
-    start = lseek(gif->fd, 0, SEEK_CUR);
+    /* Find the end of the data, then decode the sub-blocks in place. */
+    start = gif->pos;
     discard_sub_blocks(gif);
-    end = lseek(gif->fd, 0, SEEK_CUR);
-    lseek(gif->fd, start, SEEK_SET);
+    bits_init(&br, gif->data + start, gif->data + gif->pos);
     clear = 1 << key_size;
     stop = clear + 1;
     table = table_new(key_size);
     key_size++;
     init_key_size = key_size;
-    sub_len = shift = 0;
-    key = get_key(gif, key_size, &sub_len, &shift, &byte); /* clear code */
+    key = get_key(&br, key_size); /* clear code */
     frm_off = 0;
     ret = 0;
     frm_size = gif->fw * gif->fh;
@@ -307,7 +356,7 @@ static int read_image_data(twin_gif_t *gif, int interlace)
                 is_table_full = true;
             }
         }
-        key = get_key(gif, key_size, &sub_len, &shift, &byte);
+        key = get_key(&br, key_size);
         if (key == clear)
             continue;
         if (key == stop || key == 0x1000)
@@ -335,9 +384,6 @@ static int read_image_data(twin_gif_t *gif, int interlace)
             table->entries[table->n_entries - 1].suffix = entry.suffix;
     }
     twin_free(table);
-    if (key == stop)
-        read(gif->fd, &sub_len, 1); /* Must be zero! */
-    lseek(gif->fd, end, SEEK_SET);
     return 0;
 }
 
@@ -350,26 +396,26 @@ static int read_image(twin_gif_t *gif)
     int interlace;
 
     /* Image Descriptor. */
-    gif->fx = read_num(gif->fd);
-    gif->fy = read_num(gif->fd);
+    gif->fx = read_num(gif);
+    gif->fy = read_num(gif);
 
     if (gif->fx >= gif->width || gif->fy >= gif->height)
         return -1;
 
-    gif->fw = read_num(gif->fd);
-    gif->fh = read_num(gif->fd);
+    gif->fw = read_num(gif);
+    gif->fh = read_num(gif);
 
     gif->fw = MIN(gif->fw, gif->width - gif->fx);
     gif->fh = MIN(gif->fh, gif->height - gif->fy);
 
-    read(gif->fd, &fisrz, 1);
+    fisrz = read_byte(gif);
     interlace = fisrz & 0x40;
     /* Ignore Sort Flag. */
     /* Local Color table_t? */
     if (fisrz & 0x80) {
         /* Read LCT */
         gif->lct.size = 1 << ((fisrz & 0x07) + 1);
-        read(gif->fd, gif->lct.colors, 3 * gif->lct.size);
+        read_bytes(gif, gif->lct.colors, 3 * gif->lct.size);
         gif->palette = &gif->lct;
     } else
         gif->palette = &gif->gct;
@@ -418,7 +464,7 @@ static void dispose(twin_gif_t *gif)
 static void read_plain_text_ext(twin_gif_t *gif)
 {
     /* Discard plain text metadata. */
-    lseek(gif->fd, 13, SEEK_CUR);
+    skip_bytes(gif, 13);
     /* Discard plain text sub-blocks. */
     discard_sub_blocks(gif);
 }
@@ -428,15 +474,15 @@ static void read_graphic_control_ext(twin_gif_t *gif)
     uint8_t rdit;
 
     /* Discard block size (always 0x04). */
-    lseek(gif->fd, 1, SEEK_CUR);
-    read(gif->fd, &rdit, 1);
+    skip_bytes(gif, 1);
+    rdit = read_byte(gif);
     gif->gce.disposal = (rdit >> 2) & 3;
     gif->gce.input = rdit & 2;
     gif->gce.transparency = rdit & 1;
-    gif->gce.delay = read_num(gif->fd);
-    read(gif->fd, &gif->gce.tindex, 1);
+    gif->gce.delay = read_num(gif);
+    gif->gce.tindex = read_byte(gif);
     /* Skip block terminator. */
-    lseek(gif->fd, 1, SEEK_CUR);
+    skip_bytes(gif, 1);
 }
 
 static void read_comment_ext(twin_gif_t *gif)
@@ -451,17 +497,17 @@ static void read_application_ext(twin_gif_t *gif)
     char app_auth_code[3];
 
     /* Discard block size (always 0x0B). */
-    lseek(gif->fd, 1, SEEK_CUR);
+    skip_bytes(gif, 1);
     /* Application Identifier. */
-    read(gif->fd, app_id, 8);
+    read_bytes(gif, app_id, 8);
     /* Application Authentication Code. */
-    read(gif->fd, app_auth_code, 3);
+    read_bytes(gif, app_auth_code, 3);
     if (!strncmp(app_id, "NETSCAPE", sizeof(app_id))) {
         /* Discard block size (0x03) and constant byte (0x01). */
-        lseek(gif->fd, 2, SEEK_CUR);
-        gif->loop_count = read_num(gif->fd);
+        skip_bytes(gif, 2);
+        gif->loop_count = read_num(gif);
         /* Skip block terminator. */
-        lseek(gif->fd, 1, SEEK_CUR);
+        skip_bytes(gif, 1);
     } else {
         discard_sub_blocks(gif);
     }
@@ -471,8 +517,9 @@ static void read_ext(twin_gif_t *gif)
 {
     uint8_t label;
 
-    if (read(gif->fd, &label, 1) < 1)
+    if (gif_eof(gif))
         return;
+    label = read_byte(gif);
     switch (label) {
     case 0x01:
         read_plain_text_ext(gif);
@@ -491,53 +538,440 @@ static void read_ext(twin_gif_t *gif)
     }
 }
 
-/* Return 1 if got a frame; 0 if got GIF trailer; -1 if error. */
+/* Parse through the next image, the previous frame having been disposed of.
+ * Return 1 if got a frame; 0 if got GIF trailer or end of data; -1 if error.
+ */
 static int gif_get_frame(twin_gif_t *gif)
 {
     char sep;
 
-    dispose(gif);
-    read(gif->fd, &sep, 1);
+    if (gif_eof(gif))
+        return 0;
+    sep = read_byte(gif);
     while (sep != ',') {
         if (sep == ';')
             return 0;
         if (sep != '!')
             return -1;
         read_ext(gif);
-        if (read(gif->fd, &sep, 1) < 1)
+        if (gif_eof(gif))
             return -1;
+        sep = read_byte(gif);
     }
     if (read_image(gif) == -1)
         return -1;
     return 1;
 }
 
-static void gif_render_frame(twin_gif_t *gif, uint8_t *buffer)
+static void gif_close(twin_gif_t *gif)
 {
-    memcpy(buffer, gif->canvas, gif->width * gif->height * 3);
-    render_frame_rect(gif, buffer);
+    _twin_file_unmap(gif->data, gif->size, gif->mapped);
+    twin_free(gif->frame);
+    twin_free(gif);
 }
 
-static int gif_is_bgcolor(const twin_gif_t *gif, const uint8_t *color)
+/* Walk the stream without decoding any pixels, counting the frames and
+ * collecting their delays and the loop count.
+ */
+static twin_count_t gif_scan(twin_gif_t *gif, twin_time_t **delays)
 {
-    return !memcmp(&gif->palette->colors[gif->bgindex * 3], color, 3);
+    int n = 0, size = 0;
+    twin_time_t *d = NULL, *grown;
+    uint8_t fisrz;
+
+    while (!gif_eof(gif) && n < INT16_MAX) {
+        uint8_t sep = read_byte(gif);
+        if (sep == '!') {
+            read_ext(gif);
+            continue;
+        }
+        if (sep != ',')
+            break;
+        /* Image Descriptor: position and size, then the packed fields. */
+        skip_bytes(gif, 8);
+        fisrz = read_byte(gif);
+        if (fisrz & 0x80)
+            skip_bytes(gif, 3 << ((fisrz & 0x07) + 1));
+        /* LZW minimum code size, then the image data. */
+        skip_bytes(gif, 1);
+        discard_sub_blocks(gif);
+        if (n == size) {
+            size = size ? size * 2 : 16;
+            grown = twin_realloc(d, sizeof(*d) * size);
+            if (!grown)
+                break;
+            d = grown;
+        }
+        /* GIF delay in units of 1/100 second */
+        d[n++] = gif->gce.delay * 10;
+    }
+    *delays = d;
+    return n;
 }
 
-static void gif_rewind(twin_gif_t *gif)
+/* Render the @r part of the frame just parsed as ARGB32 rows @stride pixels
+ * apart, the background showing through as a checkerboard.
+ */
+static void gif_render_rect(const twin_gif_t *gif,
+                            twin_rect_t r,
+                            twin_argb32_t *dst,
+                            int stride)
 {
-    lseek(gif->fd, gif->anim_start, SEEK_SET);
+    const uint8_t *bgcolor = &gif->palette->colors[gif->bgindex * 3];
+
+    for (int y = r.top; y < r.bottom; y++, dst += stride) {
+        bool in_rows = y >= gif->fy && y < gif->fy + gif->fh;
+        twin_argb32_t *d = dst;
+
+        for (int x = r.left; x < r.right; x++) {
+            int i = y * gif->width + x;
+            const uint8_t *color = &gif->canvas[i * 3];
+
+            if (in_rows && x >= gif->fx && x < gif->fx + gif->fw) {
+                uint8_t index = gif->frame[i];
+                if (!gif->gce.transparency || index != gif->gce.tindex)
+                    color = &gif->palette->colors[index * 3];
+            }
+            if (memcmp(bgcolor, color, 3))
+                *d++ = 0xFF000000U | (color[0] << 16) | (color[1] << 8) |
+                       color[2];
+            /* Construct background */
+            else if (((y >> 3) + (x >> 3)) & 1)
+                *d++ = 0xFFAFAFAFU;
+            else
+                *d++ = 0xFF7F7F7FU;
+        }
+    }
 }
 
-static void gif_close(twin_gif_t *gif)
+/*
+ * Streaming playback
+ *
+ * Frames are decoded when the animation reaches them instead of all at
+ * load time, onto a single canvas pixmap that is updated in place. Only
+ * the bounds of the previous frame's rectangle, which its disposal may
+ * have changed, and the new frame's rectangle are rendered, and only the
+ * pixels that actually differ are written and reported as damage.
+ *
+ * Up to CONFIG_GIF_LOOKAHEAD upcoming frames are decoded from idle work
+ * and kept as deltas: the rectangle in which a frame differs from the one
+ * before it, with its pixels already disposed of and composed. Applying
+ * one costs a copy of that rectangle.
+ *
+ * Decoding frame i normally continues from frame i - 1. Every
+ * CONFIG_GIF_KEYFRAME_INTERVAL frames the decoder canvas is saved the
+ * first time the decoder passes by, so a later seek restarts from the
+ * closest saved canvas rather than from the first frame.
+ */
+typedef struct {
+    twin_count_t index; /* frame this delta leads to, or -1 */
+    bool full;          /* covers the whole canvas, applies after any frame */
+    twin_rect_t rect;
+    twin_argb32_t *pixels;
+    size_t size; /* capacity of pixels */
+} gif_delta_t;
+
+typedef struct {
+    size_t pos;
+    gif_gce_t gce;
+    uint8_t *canvas; /* NULL until the decoder first gets here */
+} gif_keyframe_t;
+
+typedef struct {
+    twin_animation_stream_t base;
+    twin_gif_t *gif;
+    twin_count_t n_frames;
+    bool loop;
+    twin_count_t next;  /* frame gif_get_frame() parses next */
+    twin_count_t shown; /* frame on the canvas, or -1 */
+    twin_pixmap_t *canvas;
+    twin_argb32_t *row;
+    /* Area in which the frame just parsed differs from the one before;
+     * the whole canvas if the decoder restarted at it. */
+    twin_rect_t changed;
+    bool full, restart;
+    gif_delta_t *deltas;
+    int interval, n_keyframes;
+    gif_keyframe_t *keyframes; /* for frames interval, 2 * interval, ... */
+    twin_work_t *work;
+    bool scheduled; /* registered as a work closure */
+} twin_gif_stream_t;
+
+static twin_rect_t gif_frame_rect(const twin_gif_t *gif)
 {
-    close(gif->fd);
-    twin_free(gif->frame);
-    twin_free(gif);
+    return (twin_rect_t){gif->fx, gif->fx + gif->fw, gif->fy,
+                         gif->fy + gif->fh};
+}
+
+static twin_rect_t gif_rect_union(twin_rect_t a, twin_rect_t b)
+{
+    if (a.left >= a.right || a.top >= a.bottom)
+        return b;
+    if (b.left >= b.right || b.top >= b.bottom)
+        return a;
+    return (twin_rect_t){MIN(a.left, b.left), MAX(a.right, b.right),
+                         MIN(a.top, b.top), MAX(a.bottom, b.bottom)};
+}
+
+static void gif_stream_save_keyframe(twin_gif_stream_t *s, int k)
+{
+    twin_gif_t *gif = s->gif;
+    gif_keyframe_t *kf = &s->keyframes[k];
+    size_t size = gif->width * gif->height * 3;
+
+    if (kf->canvas)
+        return;
+    /* On failure, seeks just start from an earlier keyframe. */
+    kf->canvas = twin_malloc(size);
+    if (!kf->canvas)
+        return;
+    memcpy(kf->canvas, gif->canvas, size);
+    kf->pos = gif->pos;
+    kf->gce = gif->gce;
+}
+
+/* Make frame @index reachable by stepping forward: keep going from the
+ * current position unless it is past @index or a keyframe is closer.
+ */
+static void gif_stream_seek(twin_gif_stream_t *s, twin_count_t index)
+{
+    twin_gif_t *gif = s->gif;
+    int k = s->interval ? index / s->interval : 0;
+    gif_keyframe_t *kf;
+
+    while (k > 0 && !s->keyframes[k - 1].canvas)
+        k--;
+    if (s->next <= index && s->next >= k * s->interval)
+        return;
+    s->restart = true;
+    if (!k) {
+        gif_reset(gif);
+        s->next = 0;
+        return;
+    }
+    kf = &s->keyframes[k - 1];
+    memcpy(gif->canvas, kf->canvas, gif->width * gif->height * 3);
+    gif->pos = kf->pos;
+    gif->gce = kf->gce;
+    /* The previous frame is already disposed of in the saved canvas. */
+    gif->fw = gif->fh = 0;
+    s->next = k * s->interval;
+}
+
+static void gif_stream_step(twin_gif_stream_t *s)
+{
+    twin_gif_t *gif = s->gif;
+    twin_rect_t before = gif_frame_rect(gif);
+
+    dispose(gif);
+    if (s->interval && s->next && s->next % s->interval == 0)
+        gif_stream_save_keyframe(s, s->next / s->interval - 1);
+    /* A broken frame shows the canvas as it stands. */
+    if (gif_get_frame(gif) <= 0)
+        gif->fw = gif->fh = 0;
+    s->full = s->restart;
+    s->restart = false;
+    if (s->full)
+        s->changed = (twin_rect_t){0, gif->width, 0, gif->height};
+    else
+        s->changed = gif_rect_union(before, gif_frame_rect(gif));
+    s->next++;
+}
+
+/* Parse up to frame @index and return the area to render for it: what
+ * changed since frame @index - 1, or everything if the decoder restarted.
+ */
+static twin_rect_t gif_stream_decode(twin_gif_stream_t *s,
+                                     twin_count_t index,
+                                     bool *full)
+{
+    gif_stream_seek(s, index);
+    while (s->next <= index)
+        gif_stream_step(s);
+    *full = s->full;
+    return s->changed;
+}
+
+/* Copy @src over @r of the canvas, extending @damage by what differed. */
+static void gif_stream_apply(twin_gif_stream_t *s,
+                             twin_rect_t r,
+                             const twin_argb32_t *src,
+                             twin_rect_t *damage)
+{
+    int width = r.right - r.left;
+
+    for (int y = r.top; y < r.bottom; y++, src += width) {
+        twin_argb32_t *dst = twin_pixmap_pointer(s->canvas, r.left, y).argb32;
+        int first = 0, last = width;
+
+        while (first < width && dst[first] == src[first])
+            first++;
+        if (first == width)
+            continue;
+        while (dst[last - 1] == src[last - 1])
+            last--;
+        memcpy(dst + first, src + first, (last - first) * sizeof(*dst));
+        *damage = gif_rect_union(
+            *damage,
+            (twin_rect_t){r.left + first, r.left + last, y, y + 1});
+    }
+}
+
+static gif_delta_t *gif_stream_delta(twin_gif_stream_t *s, twin_count_t index)
+{
+    for (int i = 0; i < CONFIG_GIF_LOOKAHEAD; i++)
+        if (s->deltas[i].index == index)
+            return &s->deltas[i];
+    return NULL;
+}
+
+/* Idle work: turn the next frame due that is not held yet into a delta. */
+static bool gif_stream_lookahead(void *closure)
+{
+    twin_gif_stream_t *s = closure;
+    gif_delta_t *delta = NULL;
+    twin_rect_t r;
+    size_t size;
+    int index = s->shown, d;
+
+    /* Reuse a slot that is free or holds a frame already played */
+    for (int i = 0; i < CONFIG_GIF_LOOKAHEAD && !delta; i++) {
+        d = (s->deltas[i].index - s->shown + s->n_frames) % s->n_frames;
+        if (s->deltas[i].index < 0 || !d || d > CONFIG_GIF_LOOKAHEAD)
+            delta = &s->deltas[i];
+    }
+    for (d = 1; delta && d <= CONFIG_GIF_LOOKAHEAD; d++) {
+        index = s->shown + d;
+        if (index >= s->n_frames) {
+            if (!s->loop)
+                break;
+            index %= s->n_frames;
+        }
+        if (gif_stream_delta(s, index))
+            continue;
+
+        delta->index = -1;
+        r = gif_stream_decode(s, index, &delta->full);
+        size = (size_t) (r.right - r.left) * (r.bottom - r.top);
+        if (size > delta->size) {
+            twin_argb32_t *pixels =
+                twin_realloc(delta->pixels, size * sizeof(*pixels));
+            if (!pixels)
+                break;
+            delta->pixels = pixels;
+            delta->size = size;
+        }
+        gif_render_rect(s->gif, r, delta->pixels, r.right - r.left);
+        delta->rect = r;
+        delta->index = index;
+        return true;
+    }
+    s->work = NULL;
+    return false;
+}
+
+static twin_pixmap_t *gif_stream_frame(twin_animation_stream_t *stream,
+                                       twin_count_t index,
+                                       twin_rect_t *damage)
+{
+    twin_gif_stream_t *s = (twin_gif_stream_t *) stream;
+    gif_delta_t *delta = gif_stream_delta(s, index);
+    bool first = s->shown < 0;
+    bool full;
+
+    *damage = (twin_rect_t){0, 0, 0, 0};
+    if (index == s->shown)
+        return s->canvas;
+
+    if (delta && (delta->full || index == s->shown + 1)) {
+        gif_stream_apply(s, delta->rect, delta->pixels, damage);
+        delta->index = -1;
+    } else {
+        twin_rect_t r = gif_stream_decode(s, index, &full);
+
+        if (!full && index != s->shown + 1)
+            r = (twin_rect_t){0, s->gif->width, 0, s->gif->height};
+        for (int y = r.top; y < r.bottom; y++) {
+            twin_rect_t row = {r.left, r.right, y, y + 1};
+            gif_render_rect(s->gif, row, s->row, 0);
+            gif_stream_apply(s, row, s->row, damage);
+        }
+    }
+    s->shown = index;
+    /*
+     * Look ahead once playback starts: the first frame is shown by the
+     * loader, which may be running on an image decoding thread.
+     */
+    if (CONFIG_GIF_LOOKAHEAD && !s->work && !first) {
+        s->work = twin_set_work(gif_stream_lookahead, TWIN_WORK_LAYOUT + 1, s);
+        s->scheduled = true;
+    }
+    return s->canvas;
+}
+
+static void gif_stream_destroy(twin_animation_stream_t *stream)
+{
+    twin_gif_stream_t *s = (twin_gif_stream_t *) stream;
+
+    twin_clear_work(s->work);
+    if (s->scheduled)
+        _twin_closure_unregister(s);
+    for (int i = 0; s->deltas && i < CONFIG_GIF_LOOKAHEAD; i++)
+        twin_free(s->deltas[i].pixels);
+    twin_free(s->deltas);
+    for (int k = 0; k < s->n_keyframes; k++)
+        twin_free(s->keyframes[k].canvas);
+    twin_free(s->keyframes);
+    twin_free(s->row);
+    if (s->canvas)
+        twin_pixmap_destroy(s->canvas);
+    if (s->gif)
+        gif_close(s->gif);
+    twin_free(s);
+}
+
+static twin_gif_stream_t *gif_stream_create(twin_gif_t *gif,
+                                            twin_count_t n_frames,
+                                            bool loop)
+{
+    twin_gif_stream_t *s = twin_calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+
+    s->base.frame = gif_stream_frame;
+    s->base.destroy = gif_stream_destroy;
+    s->gif = gif;
+    s->n_frames = n_frames;
+    s->loop = loop;
+    s->shown = -1;
+    s->interval = CONFIG_GIF_KEYFRAME_INTERVAL;
+    s->n_keyframes = s->interval ? (n_frames - 1) / s->interval : 0;
+
+    s->canvas = twin_pixmap_create(TWIN_ARGB32, gif->width, gif->height);
+    s->row = twin_malloc(gif->width * sizeof(*s->row));
+    if (CONFIG_GIF_LOOKAHEAD)
+        s->deltas = twin_calloc(CONFIG_GIF_LOOKAHEAD, sizeof(*s->deltas));
+    if (s->n_keyframes)
+        s->keyframes = twin_calloc(s->n_keyframes, sizeof(*s->keyframes));
+    if (!s->canvas || !s->row || (CONFIG_GIF_LOOKAHEAD && !s->deltas) ||
+        (s->n_keyframes && !s->keyframes)) {
+        /* Leave the decoder to the caller */
+        s->gif = NULL;
+        gif_stream_destroy(&s->base);
+        return NULL;
+    }
+    for (int i = 0; i < CONFIG_GIF_LOOKAHEAD; i++)
+        s->deltas[i].index = -1;
+    gif_reset(gif);
+    /* Nothing is on the canvas yet, so the first frame is drawn whole */
+    s->restart = true;
+    return s;
 }
 
 static twin_animation_t *_twin_animation_from_gif_file(const char *path)
 {
-    twin_animation_t *anim = twin_malloc(sizeof(twin_animation_t));
+    twin_animation_t *anim = twin_calloc(1, sizeof(twin_animation_t));
+    twin_gif_stream_t *stream;
     if (!anim)
         return NULL;
 
@@ -547,104 +981,44 @@ static twin_animation_t *_twin_animation_from_gif_file(const char *path)
         return NULL;
     }
 
-    anim->n_frames = 0;
-    anim->frames = NULL;
-    anim->frame_delays = NULL;
+    anim->n_frames = gif_scan(gif, &anim->frame_delays);
     anim->loop = gif->loop_count == 0;
     anim->width = gif->width;
     anim->height = gif->height;
-
-    int frame_count = 0;
-    while (gif_get_frame(gif))
-        frame_count++;
-
-    anim->n_frames = frame_count;
-    anim->frames = twin_malloc(sizeof(twin_pixmap_t *) * frame_count);
-    if (!anim->frames) {
-        twin_free(anim);
-        gif_close(gif);
-        return NULL;
-    }
-    anim->frame_delays = twin_malloc(sizeof(twin_time_t) * frame_count);
-    if (!anim->frame_delays) {
-        twin_free(anim->frames);
+    if (!anim->n_frames) {
+        twin_free(anim->frame_delays);
         twin_free(anim);
         gif_close(gif);
         return NULL;
     }
 
-    gif_rewind(gif);
-    uint8_t *color, *frame;
-    frame = twin_malloc(gif->width * gif->height * 3);
-    if (!frame) {
+    stream = gif_stream_create(gif, anim->n_frames, anim->loop);
+    if (!stream) {
         twin_free(anim->frame_delays);
-        twin_free(anim->frames);
         twin_free(anim);
         gif_close(gif);
         return NULL;
     }
-    for (twin_count_t i = 0; i < frame_count; i++) {
-        anim->frames[i] =
-            twin_pixmap_create(TWIN_ARGB32, gif->width, gif->height);
-        if (!anim->frames[i]) {
-            /* Free previously allocated pixmaps */
-            for (twin_count_t j = 0; j < i; j++)
-                twin_pixmap_destroy(anim->frames[j]);
-            twin_free(frame);
-            twin_free(anim->frame_delays);
-            twin_free(anim->frames);
-            twin_free(anim);
-            gif_close(gif);
-            return NULL;
-        }
-        anim->frames[i]->format = TWIN_ARGB32;
-
-        gif_render_frame(gif, frame);
-        color = frame;
-        twin_pointer_t p = twin_pixmap_pointer(anim->frames[i], 0, 0);
-        twin_coord_t row = 0, col = 0;
-        for (int j = 0; j < gif->width * gif->height; j++) {
-            uint8_t r = color[0], g = color[1], b = color[2];
-            if (!gif_is_bgcolor(gif, color))
-                *(p.argb32++) = 0xFF000000U | (r << 16) | (g << 8) | b;
-            /* Construct background */
-            else if (((row >> 3) + (col >> 3)) & 1)
-                *(p.argb32++) = 0xFFAFAFAFU;
-            else
-                *(p.argb32++) = 0xFF7F7F7FU;
-            col++;
-            if (col == gif->width) {
-                row++;
-                col = 0;
-            }
-            /* next palette */
-            color += 3;
-        }
-        /* GIF delay in units of 1/100 second */
-        anim->frame_delays[i] = gif->gce.delay * 10;
-        gif_get_frame(gif);
-    }
+    anim->stream = &stream->base;
     anim->iter = twin_animation_iter_init(anim);
     if (!anim->iter) {
-        /* Free all allocated pixmaps */
-        for (twin_count_t i = 0; i < frame_count; i++)
-            twin_pixmap_destroy(anim->frames[i]);
-        twin_free(frame);
-        twin_free(anim->frame_delays);
-        twin_free(anim->frames);
-        twin_free(anim);
-        gif_close(gif);
+        twin_animation_destroy(anim);
         return NULL;
     }
-    twin_free(frame);
-    gif_close(gif);
     return anim;
 }
 
-twin_pixmap_t *_twin_gif_to_pixmap(const char *filepath, twin_format_t fmt)
+twin_pixmap_t *_twin_gif_to_pixmap(const char *filepath,
+                                   twin_format_t fmt,
+                                   twin_coord_t max_w,
+                                   twin_coord_t max_h)
 {
     twin_pixmap_t *pix = NULL;
 
+    /* Animations are composited at native size; bounds are not applied */
+    (void) max_w;
+    (void) max_h;
+
     /* Current implementation only produces TWIN_ARGB32 */
     if (fmt != TWIN_ARGB32)
         return NULL;
@@ -41,9 +41,25 @@ static void twin_jpeg_error_exit(j_common_ptr cinfo)
     longjmp(jerr->jbuf, 1);
 }
 
-twin_pixmap_t *_twin_jpeg_to_pixmap(const char *filepath, twin_format_t fmt)
+static void twin_jpeg_to_argb32(const JSAMPLE *s,
+                                twin_argb32_t *d,
+                                JDIMENSION width)
+{
+    for (JDIMENSION i = 0; i < width; i++) {
+        uint32_t r = *(s++);
+        uint32_t g = *(s++);
+        uint32_t b = *(s++);
+        *(d++) = 0xFF000000U | (r << 16) | (g << 8) | b;
+    }
+}
+
+twin_pixmap_t *_twin_jpeg_to_pixmap(const char *filepath,
+                                    twin_format_t fmt,
+                                    twin_coord_t max_w,
+                                    twin_coord_t max_h)
 {
     twin_pixmap_t *pix = NULL;
+    twin_image_scaler_t scaler = {0};
 
     /* Current implementation only produces TWIN_ARGB32 and TWIN_A8 */
     if (fmt != TWIN_ARGB32 && fmt != TWIN_A8)
@@ -64,6 +80,7 @@ twin_pixmap_t *_twin_jpeg_to_pixmap(const char *filepath, twin_format_t fmt)
         log_error("Failed to decode %s", filepath);
         if (pix)
             twin_pixmap_destroy(pix);
+        _twin_image_scaler_fini(&scaler);
         jpeg_destroy_decompress(&cinfo);
         fclose(infile);
         return NULL;
@@ -75,12 +92,28 @@ twin_pixmap_t *_twin_jpeg_to_pixmap(const char *filepath, twin_format_t fmt)
     (void) jpeg_read_header(&cinfo, true);
 
     /* Configure */
-    twin_coord_t width = cinfo.image_width, height = cinfo.image_height;
+    twin_coord_t width, height;
+    _twin_image_fit(cinfo.image_width, cinfo.image_height, max_w, max_h,
+                    &width, &height);
     if (fmt == TWIN_ARGB32)
         cinfo.out_color_space = JCS_RGB;
     else
         cinfo.out_color_space = JCS_GRAYSCALE;
 
+    /*
+     * Let the IDCT do the bulk of any reduction: pick the smallest of the
+     * 1/2, 1/4 and 1/8 scales that still covers the requested size, and
+     * average the remainder below.
+     */
+    for (unsigned int denom = 8; denom > 1; denom >>= 1) {
+        if ((cinfo.image_width + denom - 1) / denom >= (JDIMENSION) width &&
+            (cinfo.image_height + denom - 1) / denom >= (JDIMENSION) height) {
+            cinfo.scale_num = 1;
+            cinfo.scale_denom = denom;
+            break;
+        }
+    }
+
     /* Allocate pixmap */
     pix = twin_pixmap_create(fmt, width, height);
     if (!pix)
@@ -94,30 +127,44 @@ twin_pixmap_t *_twin_jpeg_to_pixmap(const char *filepath, twin_format_t fmt)
          (cinfo.output_components != 3 && cinfo.output_components != 4)))
         longjmp(jerr.jbuf, 1);
 
+    bool scaled = cinfo.output_width != (JDIMENSION) width ||
+                  cinfo.output_height != (JDIMENSION) height;
+    if (scaled && !_twin_image_scaler_init(&scaler, pix, cinfo.output_width,
+                                           cinfo.output_height))
+        longjmp(jerr.jbuf, 1);
+
     int rowstride = cinfo.output_width * cinfo.output_components;
 
     JSAMPARRAY rowbuf = (*cinfo.mem->alloc_sarray)((j_common_ptr) &cinfo,
                                                    JPOOL_IMAGE, rowstride, 1);
+    twin_argb32_t *argb = NULL;
+    if (scaled && fmt == TWIN_ARGB32 && cinfo.output_components == 3)
+        argb = (*cinfo.mem->alloc_large)((j_common_ptr) &cinfo, JPOOL_IMAGE,
+                                         cinfo.output_width * sizeof(*argb));
 
     /* Process rows */
     while (cinfo.output_scanline < cinfo.output_height) {
+        if (scaled) {
+            (void) jpeg_read_scanlines(&cinfo, rowbuf, 1);
+            if (argb) {
+                twin_jpeg_to_argb32(*rowbuf, argb, cinfo.output_width);
+                _twin_image_scaler_row(&scaler, (const uint8_t *) argb);
+            } else {
+                _twin_image_scaler_row(&scaler, *rowbuf);
+            }
+            continue;
+        }
         twin_pointer_t p = twin_pixmap_pointer(pix, 0, cinfo.output_scanline);
         (void) jpeg_read_scanlines(&cinfo, rowbuf, 1);
         if (fmt == TWIN_A8 || cinfo.output_components == 4)
-            memcpy(p.a8, rowbuf, rowstride);
-        else {
-            JSAMPLE *s = *rowbuf;
-            for (int i = 0; i < width; i++) {
-                uint32_t r = *(s++);
-                uint32_t g = *(s++);
-                uint32_t b = *(s++);
-                *(p.argb32++) = 0xFF000000U | (r << 16) | (g << 8) | b;
-            }
-        }
+            memcpy(p.a8, *rowbuf, rowstride);
+        else
+            twin_jpeg_to_argb32(*rowbuf, p.argb32, width);
     }
 
     /* clean up */
     (void) jpeg_finish_decompress(&cinfo);
+    _twin_image_scaler_fini(&scaler);
     jpeg_destroy_decompress(&cinfo);
     fclose(infile);
 
@@ -4,81 +4,92 @@
  * All rights reserved.
  */
 
-#include <fcntl.h>
 #include <png.h>
 #include <stdlib.h>
-#include <unistd.h>
+#include <string.h>
 
 #include "twin_private.h"
 
+/*
+ * The file is mapped, or read in one go when it cannot be, and libpng is
+ * fed from memory. Rows are decoded one at a time straight into the
+ * destination pixmap and converted there while they are still in cache,
+ * so a load is a single pass over one pixmap.
+ */
 typedef struct {
-    int fd;
-} twin_png_priv_t;
+    const uint8_t *data;
+    size_t size, pos;
+    bool mapped;
+} twin_png_src_t;
 
 static void _twin_png_read(png_structp png, png_bytep data, png_size_t size)
 {
-    twin_png_priv_t *priv = png_get_io_ptr(png);
-    ssize_t n = read(priv->fd, data, size);
-    if (n <= 0 || (png_size_t) n < size)
+    twin_png_src_t *src = png_get_io_ptr(png);
+    if (size > src->size - src->pos)
         png_error(png, "end of file !\n");
+    memcpy(data, src->data + src->pos, size);
+    src->pos += size;
 }
 
-/* FIXME: Utilize pixman or similar accelerated routine to convert */
-#if defined(__APPLE__)
-static void _convertBGRtoARGB(uint8_t *data, int width, int height)
+/*
+ * Convert a row of straight RGBA bytes, as libpng returns them on every
+ * host, to premultiplied ARGB in place.
+ */
+static void _twin_png_row_to_argb32(uint8_t *row, png_uint_32 width)
 {
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int index = (y * width + x) * 4;
-            uint8_t b = data[index];
-            uint8_t g = data[index + 1];
-            uint8_t r = data[index + 2];
-            data[index] = 255; /* Alpha */
-            data[index + 1] = r;
-            data[index + 2] = g;
-            data[index + 3] = b;
+    twin_argb32_t *d = (twin_argb32_t *) row;
+
+    for (png_uint_32 x = 0; x < width; x++, row += 4) {
+        uint32_t r = row[0], g = row[1], b = row[2], a = row[3];
+        uint16_t t1, t2, t3;
+
+        if (a == 0xff) {
+            d[x] = 0xff000000U | r << 16 | g << 8 | b;
+        } else if (!a) {
+            d[x] = 0;
+        } else {
+            d[x] = a << 24 | (uint32_t) twin_int_mult(r, a, t1) << 16 |
+                   (uint32_t) twin_int_mult(g, a, t2) << 8 |
+                   twin_int_mult(b, a, t3);
         }
     }
 }
-#endif
 
-twin_pixmap_t *_twin_png_to_pixmap(const char *filepath, twin_format_t fmt)
+static void _twin_png_row_to_rgb16(twin_rgb16_t *d,
+                                   const twin_argb32_t *s,
+                                   png_uint_32 width)
 {
-    uint8_t signature[8];
-    int rb = 0;
-    png_structp png = NULL;
-    png_infop info = NULL;
-    twin_pixmap_t *pix = NULL;
-    int depth, ctype, interlace;
-    png_bytep *rowp = NULL;
-
-    int fd = open(filepath, O_RDONLY);
-    if (fd < 0)
-        goto bail;
-
-    size_t n = read(fd, signature, 8);
-    if (png_sig_cmp(signature, 0, n) != 0)
-        goto bail_close;
-
-    png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-    if (!png)
-        goto bail_close;
+    for (png_uint_32 x = 0; x < width; x++)
+        d[x] = twin_argb32_to_rgb16(s[x]);
+}
 
-    info = png_create_info_struct(png);
-    if (!info)
-        goto bail_free;
-
-    if (setjmp(png_jmpbuf(png))) {
-        if (pix)
-            twin_pixmap_destroy(pix);
-        pix = NULL;
-        goto bail_free;
-    }
+/*
+ * What a decode allocates, kept by the caller: libpng reports errors by
+ * longjmp()ing back into the function that called setjmp(), whose own
+ * locals are indeterminate afterwards if they changed in between.
+ */
+typedef struct {
+    twin_pixmap_t *pix;
+    twin_image_scaler_t scaler;
+    uint8_t *buf;
+    png_bytep *rowp;
+} twin_png_decode_t;
+
+static bool _twin_png_read_pixmap(png_structp png,
+                                  png_infop info,
+                                  twin_png_src_t *src,
+                                  twin_png_decode_t *d,
+                                  twin_format_t fmt,
+                                  twin_coord_t max_w,
+                                  twin_coord_t max_h)
+{
+    int depth, ctype, interlace, passes;
+    size_t rb = 0;
+    twin_coord_t pix_w, pix_h;
 
-    twin_png_priv_t priv = {.fd = fd};
-    png_set_read_fn(png, &priv, _twin_png_read);
+    png_set_read_fn(png, src, _twin_png_read);
 
-    png_set_sig_bytes(png, n);
+    png_set_sig_bytes(png, 8);
 
     png_read_info(png, info);
     png_uint_32 width, height;
@@ -94,58 +105,130 @@ twin_pixmap_t *_twin_png_to_pixmap(const char *filepath, twin_format_t fmt)
     if (png_get_valid(png, info, PNG_INFO_tRNS))
         png_set_tRNS_to_alpha(png);
 
-    png_get_IHDR(png, info, &width, &height, &depth, &ctype, &interlace, NULL,
-                 NULL);
-
     switch (fmt) {
     case TWIN_A8:
-        if (ctype != PNG_COLOR_TYPE_GRAY || depth != 8)
-            goto bail_free;
+        if (ctype != PNG_COLOR_TYPE_GRAY)
+            return false;
         rb = width;
         break;
     case TWIN_RGB16:
-        /* unsupported for now */
-        goto bail_free;
     case TWIN_ARGB32:
         png_set_filler(png, 0xff, PNG_FILLER_AFTER);
         if (ctype == PNG_COLOR_TYPE_GRAY || ctype == PNG_COLOR_TYPE_GRAY_ALPHA)
             png_set_gray_to_rgb(png);
-
-        png_get_IHDR(png, info, &width, &height, &depth, &ctype, &interlace,
-                     NULL, NULL);
-
-        if (depth != 8)
-            goto bail_free;
-        rb = width * 4;
+        rb = (size_t) width * 4;
         break;
     }
+    passes = png_set_interlace_handling(png);
+
+    /* Make sure the transforms produce the rows laid out above */
+    png_read_update_info(png, info);
+    if (png_get_bit_depth(png, info) != 8 || png_get_rowbytes(png, info) != rb)
+        return false;
+
+    _twin_image_fit(width, height, max_w, max_h, &pix_w, &pix_h);
+    bool scaled = (png_uint_32) pix_w != width || (png_uint_32) pix_h != height;
+    d->pix = twin_pixmap_create(fmt, pix_w, pix_h);
+    if (!d->pix)
+        return false;
+    if (scaled && !_twin_image_scaler_init(&d->scaler, d->pix, width, height))
+        return false;
+
+    /*
+     * Rows land in the pixmap itself unless they must be packed to RGB16 or
+     * reduced first. Interlaced rows are not final until the last pass, so
+     * those images are decoded whole before the rows are converted.
+     */
+    bool direct = !scaled && fmt != TWIN_RGB16;
+    if (passes > 1) {
+        d->rowp = twin_malloc(height * sizeof(png_bytep));
+        if (!d->rowp)
+            return false;
+        if (!direct) {
+            d->buf = twin_malloc(rb * height);
+            if (!d->buf)
+                return false;
+        }
+        for (png_uint_32 y = 0; y < height; y++)
+            d->rowp[y] =
+                direct ? d->pix->p.b + y * d->pix->stride : d->buf + rb * y;
+        png_read_image(png, d->rowp);
+    } else if (!direct) {
+        d->buf = twin_malloc(rb);
+        if (!d->buf)
+            return false;
+    }
 
-    rowp = twin_malloc(height * sizeof(png_bytep));
-    if (!rowp)
-        goto bail_free;
-    pix = twin_pixmap_create(fmt, width, height);
-    if (!pix)
-        goto bail_free;
-    for (size_t i = 0; i < height; i++)
-        rowp[i] = pix->p.b + rb * i;
-
-    png_read_image(png, rowp);
+    for (png_uint_32 y = 0; y < height; y++) {
+        uint8_t *row;
+        if (passes > 1) {
+            row = d->rowp[y];
+        } else {
+            row = direct ? d->pix->p.b + y * d->pix->stride : d->buf;
+            png_read_row(png, row, NULL);
+        }
+        if (fmt != TWIN_A8)
+            _twin_png_row_to_argb32(row, width);
+        if (scaled)
+            _twin_image_scaler_row(&d->scaler, row);
+        else if (fmt == TWIN_RGB16)
+            _twin_png_row_to_rgb16(
+                (twin_rgb16_t *) (d->pix->p.b + y * d->pix->stride),
+                (const twin_argb32_t *) row, width);
+    }
 
     png_read_end(png, NULL);
+    return true;
+}
+
+/* The frame libpng jumps back to holds no state of its own. */
+static bool _twin_png_decode(png_structp png,
+                             png_infop info,
+                             twin_png_src_t *src,
+                             twin_png_decode_t *d,
+                             twin_format_t fmt,
+                             twin_coord_t max_w,
+                             twin_coord_t max_h)
+{
+    if (setjmp(png_jmpbuf(png)))
+        return false;
+    return _twin_png_read_pixmap(png, info, src, d, fmt, max_w, max_h);
+}
 
-    if (fmt == TWIN_ARGB32) {
-        /* Convert from BGR to ARGB if necessary */
-#if defined(__APPLE__)
-        _convertBGRtoARGB(pix->p.b, width, height);
-#endif
-        twin_premultiply_alpha(pix);
+twin_pixmap_t *_twin_png_to_pixmap(const char *filepath,
+                                   twin_format_t fmt,
+                                   twin_coord_t max_w,
+                                   twin_coord_t max_h)
+{
+    twin_png_src_t src = {0};
+    twin_png_decode_t d = {0};
+    png_structp png = NULL;
+    png_infop info = NULL;
+
+    src.data = _twin_file_map(filepath, &src.size, &src.mapped);
+    if (!src.data)
+        return NULL;
+
+    if (src.size < 8 || png_sig_cmp(src.data, 0, 8) != 0)
+        goto bail_unmap;
+    src.pos = 8;
+
+    png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (!png)
+        goto bail_unmap;
+
+    info = png_create_info_struct(png);
+    if (info && !_twin_png_decode(png, info, &src, &d, fmt, max_w, max_h) &&
+        d.pix) {
+        twin_pixmap_destroy(d.pix);
+        d.pix = NULL;
     }
 
-bail_free:
-    twin_free(rowp);
+    _twin_image_scaler_fini(&d.scaler);
+    twin_free(d.buf);
+    twin_free(d.rowp);
     png_destroy_read_struct(&png, &info, NULL);
-bail_close:
-    close(fd);
-bail:
-    return pix;
+bail_unmap:
+    _twin_file_unmap(src.data, src.size, src.mapped);
+    return d.pix;
 }
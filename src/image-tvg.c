@@ -3,7 +3,6 @@
  * Copyright (c) 2024 National Cheng Kung University, Taiwan
  * All rights reserved.
  */
-#include <math.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -13,9 +12,10 @@
 #include "twin.h"
 #include "twin_private.h"
 
-#define D(x) twin_double_to_fixed(x)
 #define GET_COLOR(ctx, idx) ctx->colors[idx]
-#define PIXEL_ARGB(a, r, g, b) (((a) << 24) | ((r) << 16) | ((g) << 8) | (b))
+#define PIXEL_ARGB(a, r, g, b)                                   \
+    (((twin_argb32_t) (a) << 24) | ((twin_argb32_t) (r) << 16) | \
+     ((twin_argb32_t) (g) << 8) | (twin_argb32_t) (b))
 #define MIN(A, B) ((A) < (B) ? (A) : (B))
 #define ALIGN_UP(sz, alignment)                            \
     (((alignment) & ((alignment) - 1)) == 0                \
@@ -193,35 +193,20 @@ enum {
 /* flag indicating the sweep direction 0=left, 1=right */
 #define TVG_ARC_SWEEP(x) ((x >> 1) & 1)
 
-/* F32 pixel format */
-typedef struct {
-    float r, g, b, a;
-} tvg_f32_pixel_t;
-
 /* rgba32 color struct */
 typedef struct {
     uint8_t r, g, b, a;
 } tvg_rgba32_t;
 
-/* TVG internal color struct */
-typedef struct {
-    float r, g, b;
-} tvg_rgb_t;
-
-/* TVG internal color struct with alpha channel */
-typedef struct {
-    float r, g, b, a;
-} tvg_rgba_t;
-
 /* coordinate */
 typedef struct {
-    float x, y;
+    twin_fixed_t x, y;
 } tvg_point_t;
 
 /* rectangle */
 typedef struct {
-    float x, y;
-    float width, height;
+    twin_fixed_t x, y;
+    twin_fixed_t width, height;
 } tvg_rect_t;
 
 /* gradient data */
@@ -251,7 +236,7 @@ typedef struct {
 /* line header */
 typedef struct {
     tvg_style_t style;
-    float line_width;
+    twin_fixed_t line_width;
     size_t size;
 } tvg_line_header_t;
 
@@ -259,10 +244,63 @@ typedef struct {
 typedef struct {
     tvg_style_t fill_style;
     tvg_style_t line_style;
-    float line_width;
+    twin_fixed_t line_width;
     size_t size;
 } tvg_line_fill_header_t;
 
+/*
+ * Display list opcodes. Each opcode word is followed by its arguments, all
+ * in document units; arc words carry the large/sweep flags in bits 8-9.
+ */
+enum {
+    TVG_OP_MOVE = 0,    /* x, y */
+    TVG_OP_DRAW,        /* x, y */
+    TVG_OP_CURVE,       /* x1, y1, x2, y2, x3, y3 */
+    TVG_OP_QUAD,        /* x1, y1, x2, y2 */
+    TVG_OP_ARC_CIRCLE,  /* r, x0, y0, x1, y1 */
+    TVG_OP_ARC_ELLIPSE, /* rx, ry, x0, y0, x1, y1, rotation */
+    TVG_OP_RECT,        /* x, y, w, h */
+    TVG_OP_CLOSE,
+};
+
+static const uint8_t tvg_op_args[] = {2, 2, 6, 4, 5, 7, 4, 0};
+
+#define TVG_OP(op, flags) ((op) | ((flags) << 8))
+#define TVG_OP_CODE(w) ((w) & 0xFF)
+#define TVG_OP_FLAGS(w) (((w) >> 8) & 0xFF)
+
+/* style with its colors looked up, ready to paint */
+typedef struct {
+    uint8_t kind;
+    twin_argb32_t color0, color1;
+    twin_fixed_t x0, y0, x1, y1;
+} tvg_paint_t;
+
+enum {
+    TVG_ITEM_FILL = 1,
+    TVG_ITEM_STROKE = 2,
+};
+
+/* one fill and/or stroke of a path */
+typedef struct {
+    uint8_t flags;
+    tvg_paint_t fill, line;
+    twin_fixed_t pen_width;
+    /* the path, as a range of words in the op list */
+    size_t first, last;
+    /* extent of the painted area, in document units */
+    twin_fixed_t left, top, right, bottom;
+} tvg_item_t;
+
+struct _twin_tvg {
+    /* the width and height of the drawing */
+    uint32_t width, height;
+    tvg_item_t *items;
+    size_t n_items;
+    twin_fixed_t *ops;
+    size_t n_ops;
+};
+
 /* used to provide an input cursor over an arbitrary source */
 typedef size_t (*tvg_input_func_t)(uint8_t *data, size_t size, void *state);
 
@@ -271,9 +309,14 @@ typedef struct {
     tvg_input_func_t in;
     /* the user defined input state */
     void *in_state;
-    /* the target pixmap */
-    twin_pixmap_t *pixmap;
-    twin_path_t *path;
+    /* the display list being built */
+    twin_tvg_t *tvg;
+    size_t items_size, ops_size;
+    /* start and extent of the item being built */
+    size_t item_first;
+    twin_fixed_t left, top, right, bottom;
+    /* set once the display list failed to grow */
+    bool oom;
     /* the scaling used */
     uint8_t scale;
     /* the color encoding */
@@ -286,7 +329,6 @@ typedef struct {
     size_t colors_size;
     /* the color table (must be freed) */
     twin_argb32_t *colors;
-    uint32_t current_color;
 } tvg_context_t;
 
 /*
@@ -356,55 +398,46 @@ static tvg_result_t tvg_read_coord(tvg_context_t *ctx, uint32_t *out_raw_value)
     }
 }
 
+/*
+ * Scale an IEEE 754 single-precision color channel, given as its bit
+ * pattern, from [0, 1] to [0, 255] without going through the FPU.
+ */
+static uint8_t tvg_f32_to_channel(uint32_t bits)
+{
+    int exp = (int) ((bits >> 23) & 0xFF);
+    uint32_t mant = (bits & 0x7FFFFF) | 0x800000;
+
+    /* negatives, zero, denormals and anything below one step */
+    if ((bits >> 31) || exp < 127 - 24)
+        return 0;
+    if (exp >= 127)
+        return 0xFF;
+    /* value * 2^16, truncated, as twin_double_to_fixed() would give */
+    twin_fixed_t value = (twin_fixed_t) (mant >> (127 + 7 - exp));
+    return (uint8_t) twin_fixed_to_int(value * 255);
+}
+
 static tvg_result_t tvg_read_color(tvg_context_t *ctx, twin_argb32_t *out_color)
 {
     size_t read;
-    twin_fixed_t max_color_f = twin_int_to_fixed(255);
     switch (ctx->color_encoding) {
     case TVG_COLOR_F32: {
-        tvg_f32_pixel_t data;
-        READ_VALUE(read, &data, sizeof(tvg_f32_pixel_t));
-        /* 255.0 * A */
-        twin_fixed_t a_f =
-            twin_fixed_mul(max_color_f, twin_double_to_fixed(data.a));
-        /* 255.0 * R */
-        twin_fixed_t r_f =
-            twin_fixed_mul(max_color_f, twin_double_to_fixed(data.r));
-        /* 255.0 * G */
-        twin_fixed_t g_f =
-            twin_fixed_mul(max_color_f, twin_double_to_fixed(data.g));
-        /* 255.0 * B */
-        twin_fixed_t b_f =
-            twin_fixed_mul(max_color_f, twin_double_to_fixed(data.b));
-        uint8_t a = (uint8_t) twin_fixed_to_int(a_f);
-        uint8_t r = (uint8_t) twin_fixed_to_int(r_f);
-        uint8_t g = (uint8_t) twin_fixed_to_int(g_f);
-        uint8_t b = (uint8_t) twin_fixed_to_int(b_f);
+        uint32_t data[4];
+        READ_VALUE(read, data, sizeof(data));
+        uint8_t r = tvg_f32_to_channel(data[0]);
+        uint8_t g = tvg_f32_to_channel(data[1]);
+        uint8_t b = tvg_f32_to_channel(data[2]);
+        uint8_t a = tvg_f32_to_channel(data[3]);
         *out_color = PIXEL_ARGB(a, r, g, b);
         return TVG_SUCCESS;
     }
     case TVG_COLOR_U565: {
         uint16_t data;
         READ_VALUE(read, &data, 2);
-        /* (255.0 * R) / 15.0 */
-        twin_fixed_t r_f = twin_fixed_div(
-            twin_fixed_mul(max_color_f,
-                           twin_double_to_fixed((float) TVG_RGB16_R(data))),
-            twin_int_to_fixed(15));
-        /* (255.0 * G) / 31.0 */
-        twin_fixed_t g_f = twin_fixed_div(
-            twin_fixed_mul(max_color_f,
-                           twin_double_to_fixed((float) TVG_RGB16_G(data))),
-            twin_int_to_fixed(31));
-        /* (255.0 * B) / 15.0 */
-        twin_fixed_t b_f = twin_fixed_div(
-            twin_fixed_mul(max_color_f,
-                           twin_double_to_fixed((float) TVG_RGB16_B(data))),
-            twin_int_to_fixed(15));
-        uint8_t a = 0xff;
-        uint8_t r = (uint8_t) twin_fixed_to_int(r_f);
-        uint8_t g = (uint8_t) twin_fixed_to_int(g_f);
-        uint8_t b = (uint8_t) twin_fixed_to_int(b_f);
+        uint32_t a = 0xff;
+        uint32_t r = TVG_RGB16_R(data) * 255 / 31;
+        uint32_t g = TVG_RGB16_G(data) * 255 / 63;
+        uint32_t b = TVG_RGB16_B(data) * 255 / 31;
         *out_color = PIXEL_ARGB(a, r, g, b);
         return TVG_SUCCESS;
     }
@@ -424,10 +457,26 @@ static tvg_result_t tvg_read_color(tvg_context_t *ctx, twin_argb32_t *out_color)
     }
 }
 
-static float tvg_downscale_coord(tvg_context_t *ctx, uint32_t coord)
+/*
+ * Units carry ctx->scale fraction bits; twin_fixed_t has 16 and stops just
+ * short of 32768, so documents with larger coordinates are not supported.
+ */
+static tvg_result_t tvg_downscale_coord(tvg_context_t *ctx,
+                                        uint32_t coord,
+                                        twin_fixed_t *out_value)
+{
+    uint64_t value = ((uint64_t) coord << 16) >> ctx->scale;
+
+    if (value > TWIN_FIXED_MAX)
+        return TVG_E_NOT_SUPPORTED;
+    *out_value = (twin_fixed_t) value;
+    return TVG_SUCCESS;
+}
+
+/* Rotations are stored in degrees */
+static twin_angle_t tvg_degrees_to_angle(twin_fixed_t degrees)
 {
-    uint16_t factor = (((uint16_t) 1) << ctx->scale);
-    return (float) coord / (float) factor;
+    return (twin_angle_t) (((int64_t) degrees * TWIN_ANGLE_360 / 360) >> 16);
 }
 
 static tvg_result_t tvg_read_varuint(tvg_context_t *ctx, uint32_t *out_value)
@@ -448,28 +497,27 @@ static tvg_result_t tvg_read_varuint(tvg_context_t *ctx, uint32_t *out_value)
     return TVG_SUCCESS;
 }
 
-static tvg_result_t tvg_read_unit(tvg_context_t *ctx, float *out_value)
+static tvg_result_t tvg_read_unit(tvg_context_t *ctx, twin_fixed_t *out_value)
 {
     uint32_t val;
     tvg_result_t res = tvg_read_coord(ctx, &val);
     __return_val_if_fail(res, "Failed to read coordinate");
-    *out_value = tvg_downscale_coord(ctx, val);
-    return TVG_SUCCESS;
+    return tvg_downscale_coord(ctx, val, out_value);
 }
 
 static tvg_result_t tvg_read_point(tvg_context_t *ctx, tvg_point_t *out_point)
 {
-    float f32;
-    tvg_result_t res = tvg_read_unit(ctx, &f32);
+    twin_fixed_t unit;
+    tvg_result_t res = tvg_read_unit(ctx, &unit);
     __return_val_if_fail(res, "Failed to read unit");
-    out_point->x = f32;
-    res = tvg_read_unit(ctx, &f32);
+    out_point->x = unit;
+    res = tvg_read_unit(ctx, &unit);
     __return_val_if_fail(res, "Failed to read unit");
-    out_point->y = f32;
+    out_point->y = unit;
     return TVG_SUCCESS;
 }
 
-static tvg_result_t tvg_parse_header(tvg_context_t *ctx, int dim_only)
+static tvg_result_t tvg_parse_header(tvg_context_t *ctx)
 {
     size_t read = 0;
     uint8_t data[2];
@@ -498,9 +546,6 @@ static tvg_result_t tvg_parse_header(tvg_context_t *ctx, int dim_only)
     res = tvg_read_coord(ctx, &tmp);
     __return_val_if_fail(res, "Failed to read coordinate");
     ctx->height = tvg_map_zero_to_max(ctx, tmp);
-    if (dim_only) {
-        return TVG_SUCCESS;
-    }
     /* next read the color table */
     uint32_t color_count;
     res = tvg_read_varuint(ctx, &color_count);
@@ -637,22 +682,253 @@ static tvg_result_t tvg_parse_line_fill_header(
     return TVG_SUCCESS;
 }
 
+/*
+ * Display list construction
+ *
+ * Commands are compiled into items, one per fill and/or stroke, whose paths
+ * are kept as op words in document units. Each item also records the area
+ * it may touch so rendering can skip what falls outside the clip.
+ */
+static void tvg_emit(tvg_context_t *ctx,
+                     int op,
+                     int flags,
+                     const twin_fixed_t *args)
+{
+    twin_tvg_t *tvg = ctx->tvg;
+    size_t n = tvg_op_args[op];
+
+    if (tvg->n_ops + n + 1 > ctx->ops_size) {
+        size_t size = ctx->ops_size ? ctx->ops_size * 2 : 256;
+        twin_fixed_t *ops = twin_realloc(tvg->ops, size * sizeof(*ops));
+        if (!ops) {
+            ctx->oom = true;
+            return;
+        }
+        tvg->ops = ops;
+        ctx->ops_size = size;
+    }
+    tvg->ops[tvg->n_ops++] = TVG_OP(op, flags);
+    memcpy(tvg->ops + tvg->n_ops, args, n * sizeof(*args));
+    tvg->n_ops += n;
+}
+
+/* Grow the current item's extent to cover @pad around (@x, @y). */
+static void tvg_extend(tvg_context_t *ctx,
+                       twin_fixed_t x,
+                       twin_fixed_t y,
+                       twin_fixed_t pad)
+{
+    if (x - pad < ctx->left)
+        ctx->left = x - pad;
+    if (x + pad > ctx->right)
+        ctx->right = x + pad;
+    if (y - pad < ctx->top)
+        ctx->top = y - pad;
+    if (y + pad > ctx->bottom)
+        ctx->bottom = y + pad;
+}
+
+static void tvg_move(tvg_context_t *ctx, twin_fixed_t x, twin_fixed_t y)
+{
+    twin_fixed_t args[] = {x, y};
+    tvg_emit(ctx, TVG_OP_MOVE, 0, args);
+    tvg_extend(ctx, x, y, 0);
+}
+
+static void tvg_draw(tvg_context_t *ctx, twin_fixed_t x, twin_fixed_t y)
+{
+    twin_fixed_t args[] = {x, y};
+    tvg_emit(ctx, TVG_OP_DRAW, 0, args);
+    tvg_extend(ctx, x, y, 0);
+}
+
+static void tvg_close(tvg_context_t *ctx)
+{
+    tvg_emit(ctx, TVG_OP_CLOSE, 0, NULL);
+}
+
+/* Curves stay within the hull of their control points. */
+static void tvg_curve(tvg_context_t *ctx,
+                      twin_fixed_t x1,
+                      twin_fixed_t y1,
+                      twin_fixed_t x2,
+                      twin_fixed_t y2,
+                      twin_fixed_t x3,
+                      twin_fixed_t y3)
+{
+    twin_fixed_t args[] = {x1, y1, x2, y2, x3, y3};
+    tvg_emit(ctx, TVG_OP_CURVE, 0, args);
+    tvg_extend(ctx, x1, y1, 0);
+    tvg_extend(ctx, x2, y2, 0);
+    tvg_extend(ctx, x3, y3, 0);
+}
+
+static void tvg_quad(tvg_context_t *ctx,
+                     twin_fixed_t x1,
+                     twin_fixed_t y1,
+                     twin_fixed_t x2,
+                     twin_fixed_t y2)
+{
+    twin_fixed_t args[] = {x1, y1, x2, y2};
+    tvg_emit(ctx, TVG_OP_QUAD, 0, args);
+    tvg_extend(ctx, x1, y1, 0);
+    tvg_extend(ctx, x2, y2, 0);
+}
+
+/*
+ * An arc lies on an ellipse through both end points whose radii are at
+ * least half their distance, so it stays within twice the larger of the
+ * two around either end.
+ */
+static void tvg_extend_arc(tvg_context_t *ctx,
+                           twin_fixed_t radius,
+                           twin_fixed_t x0,
+                           twin_fixed_t y0,
+                           twin_fixed_t x1,
+                           twin_fixed_t y1)
+{
+    twin_fixed_t d = (abs(x1 - x0) + abs(y1 - y0)) / 2;
+    twin_fixed_t pad = 2 * (radius > d ? radius : d);
+
+    tvg_extend(ctx, x1, y1, pad);
+}
+
+static void tvg_arc_circle(tvg_context_t *ctx,
+                           int flags,
+                           twin_fixed_t radius,
+                           twin_fixed_t x0,
+                           twin_fixed_t y0,
+                           twin_fixed_t x1,
+                           twin_fixed_t y1)
+{
+    twin_fixed_t args[] = {radius, x0, y0, x1, y1};
+    tvg_emit(ctx, TVG_OP_ARC_CIRCLE, flags, args);
+    tvg_extend_arc(ctx, abs(radius), x0, y0, x1, y1);
+}
+
+static void tvg_arc_ellipse(tvg_context_t *ctx,
+                            int flags,
+                            twin_fixed_t radius_x,
+                            twin_fixed_t radius_y,
+                            twin_fixed_t x0,
+                            twin_fixed_t y0,
+                            twin_fixed_t x1,
+                            twin_fixed_t y1,
+                            twin_angle_t rotation)
+{
+    twin_fixed_t args[] = {radius_x, radius_y, x0, y0, x1, y1, rotation};
+    tvg_emit(ctx, TVG_OP_ARC_ELLIPSE, flags, args);
+    tvg_extend_arc(ctx, abs(radius_x) > abs(radius_y) ? abs(radius_x)
+                                                       : abs(radius_y),
+                   x0, y0, x1, y1);
+}
+
+static void tvg_rect(tvg_context_t *ctx,
+                     twin_fixed_t x,
+                     twin_fixed_t y,
+                     twin_fixed_t w,
+                     twin_fixed_t h)
+{
+    twin_fixed_t args[] = {x, y, w, h};
+    tvg_emit(ctx, TVG_OP_RECT, 0, args);
+    tvg_extend(ctx, x, y, 0);
+    tvg_extend(ctx, x + w, y + h, 0);
+}
+
+static tvg_result_t tvg_resolve_style(tvg_context_t *ctx,
+                                      const tvg_style_t *style,
+                                      tvg_paint_t *out_paint)
+{
+    const tvg_gradient_t *grad = &style->linear;
+
+    out_paint->kind = style->kind;
+    if (style->kind == TVG_STYLE_FLAT) {
+        if (style->flat >= ctx->colors_size)
+            return TVG_E_INVALID_FORMAT;
+        out_paint->color0 = out_paint->color1 = GET_COLOR(ctx, style->flat);
+        return TVG_SUCCESS;
+    }
+    if (style->kind == TVG_STYLE_RADIAL)
+        grad = &style->radial;
+    if (grad->color0 >= ctx->colors_size || grad->color1 >= ctx->colors_size)
+        return TVG_E_INVALID_FORMAT;
+    out_paint->color0 = GET_COLOR(ctx, grad->color0);
+    out_paint->color1 = GET_COLOR(ctx, grad->color1);
+    out_paint->x0 = grad->point0.x;
+    out_paint->y0 = grad->point0.y;
+    out_paint->x1 = grad->point1.x;
+    out_paint->y1 = grad->point1.y;
+    return TVG_SUCCESS;
+}
+
+/*
+ * Turn the ops emitted since the last item into an item filled with
+ * @fill_style and/or stroked with @line_style, either of which may be NULL.
+ */
+static tvg_result_t tvg_end_item(tvg_context_t *ctx,
+                                 const tvg_style_t *fill_style,
+                                 const tvg_style_t *line_style,
+                                 twin_fixed_t pen_width)
+{
+    twin_tvg_t *tvg = ctx->tvg;
+    tvg_item_t *item;
+    tvg_result_t res = TVG_SUCCESS;
+
+    if (ctx->oom)
+        return TVG_E_OUT_OF_MEMORY;
+    if (tvg->n_ops == ctx->item_first)
+        goto done;
+
+    if (tvg->n_items == ctx->items_size) {
+        size_t size = ctx->items_size ? ctx->items_size * 2 : 32;
+        item = twin_realloc(tvg->items, size * sizeof(*item));
+        if (!item)
+            return TVG_E_OUT_OF_MEMORY;
+        tvg->items = item;
+        ctx->items_size = size;
+    }
+    item = &tvg->items[tvg->n_items];
+    memset(item, 0, sizeof(*item));
+    if (fill_style) {
+        item->flags |= TVG_ITEM_FILL;
+        res = tvg_resolve_style(ctx, fill_style, &item->fill);
+        __return_val_if_fail(res, "Invalid fill style");
+    }
+    if (line_style) {
+        item->flags |= TVG_ITEM_STROKE;
+        item->pen_width = pen_width;
+        res = tvg_resolve_style(ctx, line_style, &item->line);
+        __return_val_if_fail(res, "Invalid line style");
+    }
+    item->first = ctx->item_first;
+    item->last = tvg->n_ops;
+    item->left = ctx->left - abs(pen_width) / 2;
+    item->top = ctx->top - abs(pen_width) / 2;
+    item->right = ctx->right + abs(pen_width) / 2;
+    item->bottom = ctx->bottom + abs(pen_width) / 2;
+    tvg->n_items++;
+done:
+    ctx->item_first = tvg->n_ops;
+    ctx->left = ctx->top = TWIN_FIXED_MAX;
+    ctx->right = ctx->bottom = TWIN_FIXED_MIN;
+    return res;
+}
+
 static tvg_result_t tvg_parse_path(tvg_context_t *ctx, size_t size)
 {
     tvg_result_t res = TVG_SUCCESS;
     tvg_point_t start_point, cur_point, pt;
-    float f32;
+    twin_fixed_t unit;
     uint8_t path_info;
-    twin_path_t *path = ctx->path;
     res = tvg_read_point(ctx, &pt);
     __goto_if_fail(res, error, "Failed to read point");
-    twin_path_move(path, D(pt.x), D(pt.y));
+    tvg_move(ctx, pt.x, pt.y);
     start_point = pt;
     cur_point = pt;
     size_t read = 0;
     for (size_t j = 0; j < size; ++j) {
         READ_VALUE(read, &path_info, 1);
-        float line_width = 0.0f;
+        twin_fixed_t line_width = 0;
         if (TVG_PATH_CMD_HAS_LINE(path_info)) {
             res = tvg_read_unit(ctx, &line_width);
             __goto_if_fail(res, error, "Failed to read unit");
@@ -661,23 +937,23 @@ static tvg_result_t tvg_parse_path(tvg_context_t *ctx, size_t size)
         case TVG_PATH_LINE:
             res = tvg_read_point(ctx, &pt);
             __goto_if_fail(res, error, "Failed to read point");
-            twin_path_draw(path, D(pt.x), D(pt.y));
+            tvg_draw(ctx, pt.x, pt.y);
             cur_point = pt;
             break;
         case TVG_PATH_HLINE:
-            res = tvg_read_unit(ctx, &f32);
+            res = tvg_read_unit(ctx, &unit);
             __goto_if_fail(res, error, "Failed to read unit");
-            pt.x = f32;
+            pt.x = unit;
             pt.y = cur_point.y;
-            twin_path_draw(path, D(pt.x), D(pt.y));
+            tvg_draw(ctx, pt.x, pt.y);
             cur_point = pt;
             break;
         case TVG_PATH_VLINE:
-            res = tvg_read_unit(ctx, &f32);
+            res = tvg_read_unit(ctx, &unit);
             __goto_if_fail(res, error, "Failed to read unit");
             pt.x = cur_point.x;
-            pt.y = f32;
-            twin_path_draw(path, D(pt.x), D(pt.y));
+            pt.y = unit;
+            tvg_draw(ctx, pt.x, pt.y);
             cur_point = pt;
             break;
         case TVG_PATH_CUBIC: {
@@ -688,28 +964,26 @@ static tvg_result_t tvg_parse_path(tvg_context_t *ctx, size_t size)
             __goto_if_fail(res, error, "Failed to read point");
             res = tvg_read_point(ctx, &end_point);
             __goto_if_fail(res, error, "Failed to read point");
-            twin_path_curve(path, D(ctrl_point1.x), D(ctrl_point1.y),
-                            D(ctrl_point2.x), D(ctrl_point2.y), D(end_point.x),
-                            D(end_point.y));
+            tvg_curve(ctx, ctrl_point1.x, ctrl_point1.y, ctrl_point2.x,
+                      ctrl_point2.y, end_point.x, end_point.y);
             cur_point = end_point;
         } break;
         case TVG_PATH_ARC_CIRCLE: {
             uint8_t circle_info;
             READ_VALUE(read, &circle_info, 1);
-            float radius;
+            twin_fixed_t radius;
             res = tvg_read_unit(ctx, &radius);
             __goto_if_fail(res, error, "Failed to read unit");
             res = tvg_read_point(ctx, &pt);
             __goto_if_fail(res, error, "Failed to read point");
-            twin_path_arc_circle(
-                path, TVG_ARC_LARGE(circle_info), TVG_ARC_SWEEP(circle_info),
-                D(radius), D(cur_point.x), D(cur_point.y), D(pt.x), D(pt.y));
+            tvg_arc_circle(ctx, circle_info & 3, radius, cur_point.x,
+                           cur_point.y, pt.x, pt.y);
             cur_point = pt;
         } break;
         case TVG_PATH_ARC_ELLIPSE: {
             uint8_t ellipse_info;
             READ_VALUE(read, &ellipse_info, 1);
-            float radius_x, radius_y, rotation;
+            twin_fixed_t radius_x, radius_y, rotation;
             res = tvg_read_unit(ctx, &radius_x);
             __goto_if_fail(res, error, "Failed to read unit");
             res = tvg_read_unit(ctx, &radius_y);
@@ -718,14 +992,13 @@ static tvg_result_t tvg_parse_path(tvg_context_t *ctx, size_t size)
             __goto_if_fail(res, error, "Failed to read unit");
             res = tvg_read_point(ctx, &pt);
             __goto_if_fail(res, error, "Failed to read point");
-            twin_path_arc_ellipse(
-                path, TVG_ARC_LARGE(ellipse_info), TVG_ARC_SWEEP(ellipse_info),
-                D(radius_x), D(radius_y), D(cur_point.x), D(cur_point.y),
-                D(pt.x), D(pt.y), rotation * TWIN_ANGLE_360 / 360);
+            tvg_arc_ellipse(ctx, ellipse_info & 3, radius_x, radius_y,
+                            cur_point.x, cur_point.y, pt.x, pt.y,
+                            tvg_degrees_to_angle(rotation));
             cur_point = pt;
         } break;
         case TVG_PATH_CLOSE:
-            twin_path_draw(path, D(start_point.x), D(start_point.y));
+            tvg_draw(ctx, start_point.x, start_point.y);
             cur_point = start_point;
             break;
         case TVG_PATH_QUAD: {
@@ -734,8 +1007,8 @@ static tvg_result_t tvg_parse_path(tvg_context_t *ctx, size_t size)
             __goto_if_fail(res, error, "Failed to read point");
             res = tvg_read_point(ctx, &end_point);
             __goto_if_fail(res, error, "Failed to read point");
-            twin_path_quadratic_curve(path, D(ctrl_point.x), D(ctrl_point.y),
-                                      D(end_point.x), D(end_point.y));
+            tvg_quad(ctx, ctrl_point.x, ctrl_point.y, end_point.x,
+                     end_point.y);
             cur_point = end_point;
         } break;
         default:
@@ -752,7 +1025,7 @@ static tvg_result_t tvg_parse_rect(tvg_context_t *ctx, tvg_rect_t *out_rect)
     tvg_point_t pt;
     tvg_result_t res = tvg_read_point(ctx, &pt);
     __return_val_if_fail(res, "Failed to read point");
-    float w, h;
+    twin_fixed_t w, h;
     res = tvg_read_unit(ctx, &w);
     __return_val_if_fail(res, "Failed to read unit");
     res = tvg_read_unit(ctx, &h);
@@ -764,51 +1037,6 @@ static tvg_result_t tvg_parse_rect(tvg_context_t *ctx, tvg_rect_t *out_rect)
     return TVG_SUCCESS;
 }
 
-static void _stroke_path_with_style(tvg_context_t *ctx,
-                                    const tvg_style_t *fill_style,
-                                    twin_fixed_t pen_width)
-{
-    switch (fill_style->kind) {
-    case TVG_STYLE_FLAT:
-        twin_paint_stroke(ctx->pixmap, GET_COLOR(ctx, fill_style->flat),
-                          ctx->path, pen_width);
-        break;
-    case TVG_STYLE_LINEAR:
-        /* TODO: Implement linear gradient color */
-        twin_paint_stroke(ctx->pixmap,
-                          GET_COLOR(ctx, fill_style->linear.color0), ctx->path,
-                          pen_width);
-        break;
-    case TVG_STYLE_RADIAL:
-        /* TODO: Implement radial gradient color */
-        twin_paint_stroke(ctx->pixmap,
-                          GET_COLOR(ctx, fill_style->radial.color0), ctx->path,
-                          pen_width);
-        break;
-    }
-}
-
-static void _fill_path_with_style(tvg_context_t *ctx,
-                                  const tvg_style_t *fill_style)
-{
-    switch (fill_style->kind) {
-    case TVG_STYLE_FLAT:
-        twin_paint_path(ctx->pixmap, GET_COLOR(ctx, fill_style->flat),
-                        ctx->path);
-        break;
-    case TVG_STYLE_LINEAR:
-        /* TODO: Implement linear gradient color */
-        twin_paint_path(ctx->pixmap, GET_COLOR(ctx, fill_style->linear.color0),
-                        ctx->path);
-        break;
-    case TVG_STYLE_RADIAL:
-        /* TODO: Implement radial gradient color */
-        twin_paint_path(ctx->pixmap, GET_COLOR(ctx, fill_style->radial.color0),
-                        ctx->path);
-        break;
-    }
-}
-
 static tvg_result_t tvg_parse_fill_rectangles(tvg_context_t *ctx,
                                               size_t size,
                                               const tvg_style_t *fill_style)
@@ -816,13 +1044,12 @@ static tvg_result_t tvg_parse_fill_rectangles(tvg_context_t *ctx,
     size_t count = size;
     tvg_result_t res;
     tvg_rect_t r;
-    twin_path_t *path = ctx->path;
     while (count--) {
         res = tvg_parse_rect(ctx, &r);
         __return_val_if_fail(res, "Failed to parse rect");
-        twin_path_rectangle(path, D(r.x), D(r.y), D(r.width), D(r.height));
-        _fill_path_with_style(ctx, fill_style);
-        twin_path_empty(path);
+        tvg_rect(ctx, r.x, r.y, r.width, r.height);
+        res = tvg_end_item(ctx, fill_style, NULL, 0);
+        __return_val_if_fail(res, "Failed to add rect");
     }
     return TVG_SUCCESS;
 }
@@ -832,23 +1059,21 @@ static tvg_result_t tvg_parse_line_fill_rectangles(
     size_t size,
     const tvg_style_t *fill_style,
     const tvg_style_t *line_style,
-    float line_width)
+    twin_fixed_t line_width)
 {
     size_t count = size;
     tvg_result_t res;
     tvg_rect_t r;
     if (line_width == 0) {
-        line_width = .01;
+        line_width = TWIN_FIXED_ONE / 100;
     }
-    twin_path_t *path = ctx->path;
     while (count--) {
         res = tvg_parse_rect(ctx, &r);
         __return_val_if_fail(res, "Failed to parse rect");
 
-        twin_path_rectangle(path, D(r.x), D(r.y), D(r.width), D(r.height));
-        _fill_path_with_style(ctx, fill_style);
-        _stroke_path_with_style(ctx, line_style, D(line_width));
-        twin_path_empty(path);
+        tvg_rect(ctx, r.x, r.y, r.width, r.height);
+        res = tvg_end_item(ctx, fill_style, line_style, line_width);
+        __return_val_if_fail(res, "Failed to add rect");
     }
     return TVG_SUCCESS;
 }
@@ -867,14 +1092,12 @@ static tvg_result_t tvg_parse_fill_paths(tvg_context_t *ctx,
         ++sizes[i];
         __goto_if_fail(res, error, "Failed to read varuint");
     }
-    twin_path_t *path = ctx->path;
     /* parse path */
     for (size_t i = 0; i < size; ++i) {
         res = tvg_parse_path(ctx, sizes[i]);
         __goto_if_fail(res, error, "Failed to parse path");
     }
-    _fill_path_with_style(ctx, style);
-    twin_path_empty(path);
+    res = tvg_end_item(ctx, style, NULL, 0);
 error:
     twin_free(sizes);
     return res;
@@ -883,14 +1106,13 @@ error:
 static tvg_result_t tvg_parse_line_paths(tvg_context_t *ctx,
                                          size_t size,
                                          const tvg_style_t *line_style,
-                                         float line_width)
+                                         twin_fixed_t line_width)
 {
     tvg_result_t res = TVG_SUCCESS;
     uint32_t *sizes = twin_malloc(size * sizeof(uint32_t));
     if (!sizes) {
         return TVG_E_OUT_OF_MEMORY;
     }
-    twin_path_t *path = ctx->path;
     for (size_t i = 0; i < size; ++i) {
         res = tvg_read_varuint(ctx, &sizes[i]);
         ++sizes[i];
@@ -901,8 +1123,7 @@ static tvg_result_t tvg_parse_line_paths(tvg_context_t *ctx,
         res = tvg_parse_path(ctx, sizes[i]);
         __goto_if_fail(res, error, "Failed to parse path");
     }
-    _stroke_path_with_style(ctx, line_style, D(line_width));
-    twin_path_empty(path);
+    res = tvg_end_item(ctx, NULL, line_style, line_width);
 error:
     twin_free(sizes);
     return res;
@@ -912,7 +1133,7 @@ static tvg_result_t tvg_parse_line_fill_paths(tvg_context_t *ctx,
                                               size_t size,
                                               const tvg_style_t *fill_style,
                                               const tvg_style_t *line_style,
-                                              float line_width)
+                                              twin_fixed_t line_width)
 {
     tvg_result_t res = TVG_SUCCESS;
     uint32_t *sizes = twin_malloc(size * sizeof(uint32_t));
@@ -924,7 +1145,6 @@ static tvg_result_t tvg_parse_line_fill_paths(tvg_context_t *ctx,
         ++sizes[i];
         __goto_if_fail(res, error, "Failed to read varuint");
     }
-    twin_path_t *path = ctx->path;
 
     /* parse path */
     for (size_t i = 0; i < size; ++i) {
@@ -932,11 +1152,9 @@ static tvg_result_t tvg_parse_line_fill_paths(tvg_context_t *ctx,
         __goto_if_fail(res, error, "Failed to parse path");
     }
     if (line_width == 0) {
-        line_width = .1;
+        line_width = TWIN_FIXED_ONE / 10;
     }
-    _fill_path_with_style(ctx, fill_style);
-    _stroke_path_with_style(ctx, line_style, D(line_width));
-    twin_path_empty(path);
+    res = tvg_end_item(ctx, fill_style, line_style, line_width);
 error:
     twin_free(sizes);
     return res;
@@ -950,95 +1168,84 @@ static tvg_result_t tvg_parse_fill_polygon(tvg_context_t *ctx,
     tvg_point_t pt;
     tvg_result_t res = tvg_read_point(ctx, &pt);
     __return_val_if_fail(res, "Failed to read point");
-    twin_path_t *path = ctx->path;
-    twin_path_move(path, D(pt.x), D(pt.y));
+    tvg_move(ctx, pt.x, pt.y);
     while (--count) {
         res = tvg_read_point(ctx, &pt);
         __return_val_if_fail(res, "Failed to read point");
-        twin_path_draw(path, D(pt.x), D(pt.y));
+        tvg_draw(ctx, pt.x, pt.y);
     }
-    twin_path_close(path);
-    _fill_path_with_style(ctx, fill_style);
-    twin_path_empty(path);
-    return TVG_SUCCESS;
+    tvg_close(ctx);
+    return tvg_end_item(ctx, fill_style, NULL, 0);
 }
 
 static tvg_result_t tvg_parse_polyline(tvg_context_t *ctx,
                                        size_t size,
                                        const tvg_style_t *line_style,
-                                       float line_width,
+                                       twin_fixed_t line_width,
                                        bool close)
 {
     tvg_point_t pt;
     tvg_result_t res = tvg_read_point(ctx, &pt);
     __return_val_if_fail(res, "Failed to read point");
-    twin_path_t *path = ctx->path;
-    twin_path_move(path, D(pt.x), D(pt.y));
+    tvg_move(ctx, pt.x, pt.y);
     for (size_t i = 1; i < size; ++i) {
         res = tvg_read_point(ctx, &pt);
         __return_val_if_fail(res, "Failed to read point");
-        twin_path_draw(path, D(pt.x), D(pt.y));
+        tvg_draw(ctx, pt.x, pt.y);
     }
     if (close) {
-        twin_path_close(path);
+        tvg_close(ctx);
     }
     if (line_width == 0) {
-        line_width = .01;
+        line_width = TWIN_FIXED_ONE / 100;
     }
-    _stroke_path_with_style(ctx, line_style, D(line_width));
-    twin_path_empty(path);
-    return TVG_SUCCESS;
+    return tvg_end_item(ctx, NULL, line_style, line_width);
 }
 
 static tvg_result_t tvg_parse_line_fill_polyline(tvg_context_t *ctx,
                                                  size_t size,
                                                  const tvg_style_t *fill_style,
                                                  const tvg_style_t *line_style,
-                                                 float line_width,
+                                                 twin_fixed_t line_width,
                                                  bool close)
 {
     tvg_point_t pt;
     tvg_result_t res = tvg_read_point(ctx, &pt);
-    twin_path_t *path = ctx->path;
-    twin_path_move(path, D(pt.x), D(pt.y));
+    __return_val_if_fail(res, "Failed to read point");
+    tvg_move(ctx, pt.x, pt.y);
     for (size_t i = 1; i < size; ++i) {
         res = tvg_read_point(ctx, &pt);
         __return_val_if_fail(res, "Failed to read point");
+        tvg_draw(ctx, pt.x, pt.y);
     }
     if (close) {
-        twin_path_close(path);
+        tvg_close(ctx);
     }
-    _fill_path_with_style(ctx, fill_style);
     if (line_width == 0) {
-        line_width = .01;
+        line_width = TWIN_FIXED_ONE / 100;
     }
-    _stroke_path_with_style(ctx, line_style, D(line_width));
-    twin_path_empty(path);
-    return res;
+    return tvg_end_item(ctx, fill_style, line_style, line_width);
 }
 
 static tvg_result_t tvg_parse_lines(tvg_context_t *ctx,
                                     size_t size,
                                     const tvg_style_t *line_style,
-                                    float line_width)
+                                    twin_fixed_t line_width)
 {
     tvg_point_t pt;
     tvg_result_t res;
-    twin_path_t *path = ctx->path;
     for (size_t i = 0; i < size; ++i) {
         res = tvg_read_point(ctx, &pt);
         __return_val_if_fail(res, "Failed to read point");
-        twin_path_move(path, D(pt.x), D(pt.y));
+        tvg_move(ctx, pt.x, pt.y);
         res = tvg_read_point(ctx, &pt);
         __return_val_if_fail(res, "Failed to read point");
-        twin_path_draw(path, D(pt.x), D(pt.y));
+        tvg_draw(ctx, pt.x, pt.y);
     }
     if (line_width == 0) {
-        line_width = .01;
+        line_width = TWIN_FIXED_ONE / 100;
     }
-    _stroke_path_with_style(ctx, line_style, D(line_width));
-    twin_path_empty(path);
-    return TVG_SUCCESS;
+    return tvg_end_item(ctx, NULL, line_style, line_width);
 }
 
 static tvg_result_t tvg_parse_commands(tvg_context_t *ctx)
@@ -1139,204 +1346,342 @@ static tvg_result_t tvg_parse_commands(tvg_context_t *ctx)
     return TVG_SUCCESS;
 }
 
-static tvg_result_t tvg_document_dimensions(tvg_input_func_t in,
-                                            void *in_state,
-                                            uint32_t *out_width,
-                                            uint32_t *out_height)
-{
-    /* initialize the context */
-    tvg_context_t ctx;
-    if (!in) {
-        return TVG_E_INVALID_ARG;
-    }
-    ctx.in = in;
-    ctx.in_state = in_state;
-    ctx.colors = NULL;
-    ctx.colors_size = 0;
-    /* parse the header, early outing before the color table */
-    tvg_result_t res = tvg_parse_header(&ctx, 1);
-    __return_val_if_fail(res, "Failed to parse header");
-    *out_width = ctx.width;
-    *out_height = ctx.height;
-    return res;
-}
-
-static tvg_result_t tvg_render_document(tvg_input_func_t in,
-                                        void *in_state,
-                                        twin_pixmap_t *pix,
-                                        twin_fixed_t width_scale,
-                                        twin_fixed_t height_scale)
-{
-    /* initialize the context */
-    tvg_context_t ctx;
-    if (!in) {
-        return TVG_E_INVALID_ARG;
-    }
-    ctx.in = in;
-    ctx.in_state = in_state;
-    ctx.pixmap = pix;
-    ctx.colors = NULL;
-    ctx.colors_size = 0;
-    /* parse the header */
-    tvg_result_t res = tvg_parse_header(&ctx, 0);
-    __goto_if_fail(res, error, "Failed to parse header");
-    ctx.path = twin_path_create();
-    if (!ctx.path) {
-        log_error("Failed to create path");
-        goto error;
-    }
-    twin_path_scale(ctx.path, width_scale, height_scale);
-    res = tvg_parse_commands(&ctx);
-    __goto_if_fail(res, error, "Failed to parse commands");
-error:
-    if (ctx.path) {
-        twin_path_destroy(ctx.path);
-        ctx.path = NULL;
-    }
-    if (ctx.colors) {
-        twin_free(ctx.colors);
-        ctx.colors = NULL;
-        ctx.colors_size = 0;
-    }
-    return res;
-}
-
 static size_t inp_func(uint8_t *data, size_t to_read, void *state)
 {
     FILE *f = (FILE *) state;
     return fread(data, 1, to_read, f);
 }
 
-twin_pixmap_t *_twin_tvg_to_pixmap(const char *filepath, twin_format_t fmt)
+twin_tvg_t *twin_tvg_load(const char *filepath)
 {
-    FILE *infile = NULL;
-    twin_pixmap_t *pix = NULL;
-    uint32_t width, height;
+    FILE *infile;
+    twin_tvg_t *tvg;
     tvg_result_t res;
+    tvg_context_t ctx = {
+        .in = inp_func,
+        .left = TWIN_FIXED_MAX,
+        .top = TWIN_FIXED_MAX,
+        .right = TWIN_FIXED_MIN,
+        .bottom = TWIN_FIXED_MIN,
+    };
 
     if (!filepath) {
         log_error("Invalid filepath");
-        goto bail;
+        return NULL;
     }
 
     infile = fopen(filepath, "rb");
     if (!infile) {
         log_error("Failed to open %s", filepath);
-        goto bail;
-    }
-
-    res = tvg_document_dimensions(inp_func, infile, &width, &height);
-    if (res != TVG_SUCCESS) {
-        log_error("Failed to get document dimensions");
-        goto bail_infile;
+        return NULL;
     }
 
-    if (fseek(infile, 0, SEEK_SET) != 0) {
-        log_error("Failed to seek file");
+    tvg = twin_calloc(1, sizeof(*tvg));
+    if (!tvg)
         goto bail_infile;
-    }
+    ctx.in_state = infile;
+    ctx.tvg = tvg;
 
-    pix = twin_pixmap_create(fmt, width, height);
-    if (!pix) {
-        log_error("Failed to create pixmap");
-        goto bail_infile;
+    res = tvg_parse_header(&ctx);
+    __goto_if_fail(res, bail_tvg, "Failed to parse header");
+    tvg->width = ctx.width;
+    tvg->height = ctx.height;
+    res = tvg_parse_commands(&ctx);
+    __goto_if_fail(res, bail_tvg, "Failed to parse commands");
+
+    /* The lists are complete; give back what was reserved for growth */
+    if (tvg->n_items && tvg->n_items < ctx.items_size) {
+        tvg_item_t *items =
+            twin_realloc(tvg->items, tvg->n_items * sizeof(*items));
+        if (items)
+            tvg->items = items;
     }
-
-    res = tvg_render_document(inp_func, infile, pix, TWIN_FIXED_ONE,
-                              TWIN_FIXED_ONE);
-    if (res != TVG_SUCCESS) {
-        log_error("Failed to render document");
-        goto bail_pixmap;
+    if (tvg->n_ops && tvg->n_ops < ctx.ops_size) {
+        twin_fixed_t *ops = twin_realloc(tvg->ops, tvg->n_ops * sizeof(*ops));
+        if (ops)
+            tvg->ops = ops;
     }
 
+    twin_free(ctx.colors);
     fclose(infile);
-    return pix;
+    return tvg;
 
-bail_pixmap:
-    twin_pixmap_destroy(pix);
+bail_tvg:
+    twin_free(ctx.colors);
+    twin_tvg_destroy(tvg);
 bail_infile:
     fclose(infile);
-bail:
     return NULL;
 }
 
-twin_pixmap_t *twin_tvg_to_pixmap_scale(const char *filepath,
-                                        twin_format_t fmt,
-                                        twin_coord_t w,
-                                        twin_coord_t h)
+void twin_tvg_destroy(twin_tvg_t *tvg)
 {
-    FILE *infile = NULL;
-    twin_pixmap_t *pix = NULL;
-    uint32_t width, height;
-    tvg_result_t res;
+    if (!tvg)
+        return;
+    twin_free(tvg->items);
+    twin_free(tvg->ops);
+    twin_free(tvg);
+}
 
-    if (!filepath) {
-        log_error("Invalid filepath");
-        goto bail;
+void twin_tvg_get_size(const twin_tvg_t *tvg, uint32_t *width, uint32_t *height)
+{
+    if (width)
+        *width = tvg ? tvg->width : 0;
+    if (height)
+        *height = tvg ? tvg->height : 0;
+}
+
+/*
+ * Gradient points are in document units; carry them through the path
+ * matrix so the gradient lands where the shape does. The radial rim is one
+ * point on the circle, which is exact for uniform scales and rotations.
+ */
+static void tvg_paint_operand(const tvg_paint_t *paint,
+                              twin_path_t *path,
+                              twin_gradient_t *g,
+                              twin_operand_t *src)
+{
+    twin_matrix_t m = twin_path_current_matrix(path);
+
+    if (paint->kind == TVG_STYLE_FLAT) {
+        src->source_kind = TWIN_SOLID;
+        src->u.argb = paint->color0;
+        return;
     }
+    g->x0 = twin_matrix_transform_x(&m, paint->x0, paint->y0);
+    g->y0 = twin_matrix_transform_y(&m, paint->x0, paint->y0);
+    g->x1 = twin_matrix_transform_x(&m, paint->x1, paint->y1);
+    g->y1 = twin_matrix_transform_y(&m, paint->x1, paint->y1);
+    g->color0 = paint->color0;
+    g->color1 = paint->color1;
+    src->source_kind = paint->kind == TVG_STYLE_LINEAR ? TWIN_LINEAR_GRADIENT
+                                                       : TWIN_RADIAL_GRADIENT;
+    src->u.gradient = g;
+}
 
-    infile = fopen(filepath, "rb");
-    if (!infile) {
-        log_error("Failed to open %s", filepath);
-        goto bail;
+static twin_scratch_t *tvg_scratch(twin_pixmap_t *dst, twin_scratch_t *scratch)
+{
+    if (!dst->screen || !dst->screen->scratch_buf)
+        return NULL;
+    twin_scratch_init(scratch, dst->screen->scratch_buf,
+                      dst->screen->scratch_size);
+    return scratch;
+}
+
+static void _stroke_path_with_style(twin_pixmap_t *dst,
+                                    twin_path_t *path,
+                                    const tvg_paint_t *paint,
+                                    twin_fixed_t pen_width)
+{
+    twin_gradient_t g;
+    twin_operand_t src;
+    twin_scratch_t scratch;
+
+    tvg_paint_operand(paint, path, &g, &src);
+    twin_composite_stroke(dst, &src, 0, 0, path, pen_width, TWIN_OVER,
+                          tvg_scratch(dst, &scratch));
+}
+
+static void _fill_path_with_style(twin_pixmap_t *dst,
+                                  twin_path_t *path,
+                                  const tvg_paint_t *paint)
+{
+    twin_gradient_t g;
+    twin_operand_t src;
+    twin_scratch_t scratch;
+
+    tvg_paint_operand(paint, path, &g, &src);
+    twin_composite_path(dst, &src, 0, 0, path, TWIN_OVER,
+                        tvg_scratch(dst, &scratch));
+}
+
+static void tvg_replay(const twin_tvg_t *tvg,
+                       const tvg_item_t *item,
+                       twin_path_t *path)
+{
+    const twin_fixed_t *op = tvg->ops + item->first;
+    const twin_fixed_t *end = tvg->ops + item->last;
+
+    for (; op < end; op += 1 + tvg_op_args[TVG_OP_CODE(*op)]) {
+        const twin_fixed_t *a = op + 1;
+        int flags = TVG_OP_FLAGS(*op);
+
+        switch (TVG_OP_CODE(*op)) {
+        case TVG_OP_MOVE:
+            twin_path_move(path, a[0], a[1]);
+            break;
+        case TVG_OP_DRAW:
+            twin_path_draw(path, a[0], a[1]);
+            break;
+        case TVG_OP_CURVE:
+            twin_path_curve(path, a[0], a[1], a[2], a[3], a[4], a[5]);
+            break;
+        case TVG_OP_QUAD:
+            twin_path_quadratic_curve(path, a[0], a[1], a[2], a[3]);
+            break;
+        case TVG_OP_ARC_CIRCLE:
+            twin_path_arc_circle(path, TVG_ARC_LARGE(flags),
+                                 TVG_ARC_SWEEP(flags), a[0], a[1], a[2], a[3],
+                                 a[4]);
+            break;
+        case TVG_OP_ARC_ELLIPSE:
+            twin_path_arc_ellipse(path, TVG_ARC_LARGE(flags),
+                                  TVG_ARC_SWEEP(flags), a[0], a[1], a[2], a[3],
+                                  a[4], a[5], (twin_angle_t) a[6]);
+            break;
+        case TVG_OP_RECT:
+            twin_path_rectangle(path, a[0], a[1], a[2], a[3]);
+            break;
+        case TVG_OP_CLOSE:
+            twin_path_close(path);
+            break;
+        }
+    }
+}
+
+/* Whether @item, drawn through @m, may touch @clip */
+static bool tvg_item_visible(const tvg_item_t *item,
+                             const twin_matrix_t *m,
+                             twin_rect_t clip)
+{
+    twin_fixed_t left = TWIN_FIXED_MAX, top = TWIN_FIXED_MAX;
+    twin_fixed_t right = TWIN_FIXED_MIN, bottom = TWIN_FIXED_MIN;
+
+    for (int i = 0; i < 4; i++) {
+        twin_fixed_t x = i & 1 ? item->right : item->left;
+        twin_fixed_t y = i & 2 ? item->bottom : item->top;
+        twin_fixed_t tx = twin_matrix_transform_x(m, x, y);
+        twin_fixed_t ty = twin_matrix_transform_y(m, x, y);
+
+        if (tx < left)
+            left = tx;
+        if (tx > right)
+            right = tx;
+        if (ty < top)
+            top = ty;
+        if (ty > bottom)
+            bottom = ty;
     }
+    /* Allow a pixel of antialiasing on each side */
+    return twin_fixed_to_int(left) - 1 < clip.right &&
+           twin_fixed_to_int(right) + 1 >= clip.left &&
+           twin_fixed_to_int(top) - 1 < clip.bottom &&
+           twin_fixed_to_int(bottom) + 1 >= clip.top;
+}
 
-    res = tvg_document_dimensions(inp_func, infile, &width, &height);
-    __goto_if_fail(res, bail_infile, "Failed to get document dimensions");
+void twin_tvg_render(const twin_tvg_t *tvg,
+                     twin_pixmap_t *dst,
+                     const twin_matrix_t *transform)
+{
+    twin_path_t *path;
+    twin_matrix_t m;
+    twin_rect_t clip;
 
-    if (fseek(infile, 0, SEEK_SET) != 0) {
-        log_error("Failed to seek file");
-        goto bail_infile;
+    if (!tvg || !dst)
+        return;
+
+    path = twin_path_create();
+    if (!path) {
+        log_error("Failed to create path");
+        return;
+    }
+    if (transform)
+        m = *transform;
+    else
+        twin_matrix_identity(&m);
+    twin_path_set_matrix(path, m);
+    clip = twin_pixmap_get_clip(dst);
+
+    for (size_t i = 0; i < tvg->n_items; i++) {
+        const tvg_item_t *item = &tvg->items[i];
+
+        if (!tvg_item_visible(item, &m, clip))
+            continue;
+        tvg_replay(tvg, item, path);
+        if (item->flags & TVG_ITEM_FILL)
+            _fill_path_with_style(dst, path, &item->fill);
+        if (item->flags & TVG_ITEM_STROKE)
+            _stroke_path_with_style(dst, path, &item->line, item->pen_width);
+        twin_path_empty(path);
     }
+    twin_path_destroy(path);
+}
+
+twin_pixmap_t *twin_tvg_to_pixmap(const twin_tvg_t *tvg,
+                                  twin_format_t fmt,
+                                  twin_coord_t w,
+                                  twin_coord_t h)
+{
+    twin_pixmap_t *pix;
+    twin_matrix_t m;
+
+    if (!tvg || w <= 0 || h <= 0)
+        return NULL;
 
     pix = twin_pixmap_create(fmt, w, h);
     if (!pix) {
         log_error("Failed to create pixmap");
-        goto bail_infile;
+        return NULL;
     }
-    twin_fixed_t width_scale = D((double) w / (double) width);
-    twin_fixed_t height_scale = D((double) h / (double) height);
-    twin_fixed_t scale = MIN(width_scale, height_scale);
-    res = tvg_render_document(inp_func, infile, pix, scale, scale);
-    __goto_if_fail(res, bail_pixmap, "Failed to render document");
 
-    fclose(infile);
+    /* Same scale on both axes, so the drawing keeps its aspect ratio */
+    twin_fixed_t scale = MIN(((int64_t) w << 16) / tvg->width,
+                             ((int64_t) h << 16) / tvg->height);
+    twin_matrix_identity(&m);
+    twin_matrix_scale(&m, scale, scale);
+    twin_tvg_render(tvg, pix, &m);
     return pix;
+}
 
-bail_pixmap:
-    twin_pixmap_destroy(pix);
-bail_infile:
-    fclose(infile);
-bail:
-    return NULL;
+twin_pixmap_t *_twin_tvg_to_pixmap(const char *filepath,
+                                   twin_format_t fmt,
+                                   twin_coord_t max_w,
+                                   twin_coord_t max_h)
+{
+    twin_tvg_t *tvg = twin_tvg_load(filepath);
+    twin_pixmap_t *pix;
+    twin_coord_t w, h;
+
+    if (!tvg)
+        return NULL;
+    _twin_image_fit(tvg->width, tvg->height, max_w, max_h, &w, &h);
+    pix = twin_tvg_to_pixmap(tvg, fmt, w, h);
+    twin_tvg_destroy(tvg);
+    return pix;
+}
+
+twin_pixmap_t *twin_tvg_to_pixmap_scale(const char *filepath,
+                                        twin_format_t fmt,
+                                        twin_coord_t w,
+                                        twin_coord_t h)
+{
+    twin_tvg_t *tvg = twin_tvg_load(filepath);
+    twin_pixmap_t *pix;
+
+    if (!tvg)
+        return NULL;
+    pix = twin_tvg_to_pixmap(tvg, fmt, w, h);
+    twin_tvg_destroy(tvg);
+    return pix;
 }
 
 twin_pixmap_t *twin_tvg_to_pixmap_budget(const char *filepath,
                                          twin_format_t fmt,
                                          size_t memory_budget)
 {
-    FILE *infile = NULL;
+    twin_tvg_t *tvg = twin_tvg_load(filepath);
+    twin_pixmap_t *pix = NULL;
     uint32_t width, height;
 
-    if (!filepath)
-        return NULL;
-
-    infile = fopen(filepath, "rb");
-    if (!infile)
-        return NULL;
-
-    tvg_result_t res =
-        tvg_document_dimensions(inp_func, infile, &width, &height);
-    fclose(infile);
-    if (res != TVG_SUCCESS)
+    if (!tvg)
         return NULL;
+    width = tvg->width;
+    height = tvg->height;
 
     /* Compute the largest output dimensions that fit within budget */
-    if (width == 0 || height == 0)
-        return NULL;
     size_t full_size;
     if (!tvg_pixmap_alloc_size(fmt, width, height, &full_size))
-        return NULL;
+        goto out;
 
     /* Clamp to twin_coord_t range (int16_t max = 32767) */
     if (width > 32767)
@@ -1350,7 +1695,7 @@ twin_pixmap_t *twin_tvg_to_pixmap_budget(const char *filepath,
         out_h = (twin_coord_t) height;
     } else {
         if (memory_budget <= sizeof(twin_pixmap_t))
-            return NULL;
+            goto out;
 
         uint32_t lo = 1;
         uint32_t hi = height;
@@ -1376,11 +1721,14 @@ twin_pixmap_t *twin_tvg_to_pixmap_budget(const char *filepath,
         }
 
         if (best_w == 0 || best_h == 0)
-            return NULL;
+            goto out;
 
         out_w = (twin_coord_t) best_w;
         out_h = (twin_coord_t) best_h;
     }
 
-    return twin_tvg_to_pixmap_scale(filepath, fmt, out_w, out_h);
+    pix = twin_tvg_to_pixmap(tvg, fmt, out_w, out_h);
+out:
+    twin_tvg_destroy(tvg);
+    return pix;
 }
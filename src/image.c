@@ -4,8 +4,12 @@
  * All rights reserved.
  */
 
+#include <fcntl.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "twin_private.h"
 
@@ -114,11 +118,16 @@ static twin_image_format_t image_type_detect(const char *path)
 /* Function prototypes for implementations */
 #define _(x)                                                   \
     twin_pixmap_t *_twin_##x##_to_pixmap(const char *filepath, \
-                                         twin_format_t fmt);
+                                         twin_format_t fmt,    \
+                                         twin_coord_t max_w,   \
+                                         twin_coord_t max_h);
 SUPPORTED_FORMATS
 #undef _
 
-typedef twin_pixmap_t *(*loader_func_t)(const char *, twin_format_t);
+typedef twin_pixmap_t *(*loader_func_t)(const char *,
+                                        twin_format_t,
+                                        twin_coord_t,
+                                        twin_coord_t);
 
 /* clang-format off */
 static loader_func_t image_loaders[] = {
@@ -130,9 +139,198 @@ static loader_func_t image_loaders[] = {
 /* clang-format on */
 
 twin_pixmap_t *twin_pixmap_from_file(const char *path, twin_format_t fmt)
+{
+    return twin_pixmap_from_file_scaled(path, fmt, 0, 0);
+}
+
+twin_pixmap_t *twin_pixmap_from_file_scaled(const char *path,
+                                            twin_format_t fmt,
+                                            twin_coord_t max_w,
+                                            twin_coord_t max_h)
 {
     loader_func_t loader = image_loaders[image_type_detect(path)];
     if (!loader)
         return NULL;
-    return loader(path, fmt);
+    return loader(path, fmt, max_w, max_h);
+}
+
+#if CONFIG_LOADER_PNG || CONFIG_LOADER_GIF
+const uint8_t *_twin_file_map(const char *path, size_t *size, bool *mapped)
+{
+    struct stat st;
+    uint8_t *buf;
+    size_t got = 0;
+    ssize_t n;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+#ifdef _WIN32
+    setmode(fd, O_BINARY);
+#endif
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    *size = st.st_size;
+    buf = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (buf != MAP_FAILED) {
+        close(fd);
+        *mapped = true;
+        return buf;
+    }
+    /* Fall back to a single buffered read of the whole file */
+    buf = twin_malloc(*size);
+    if (buf) {
+        while (got < *size && (n = read(fd, buf + got, *size - got)) > 0)
+            got += n;
+    }
+    close(fd);
+    *size = got;
+    *mapped = false;
+    return buf;
+}
+
+void _twin_file_unmap(const uint8_t *data, size_t size, bool mapped)
+{
+    if (mapped)
+        munmap((void *) data, size);
+    else
+        twin_free((void *) data);
+}
+#endif
+
+void _twin_image_fit(uint32_t width,
+                     uint32_t height,
+                     twin_coord_t max_w,
+                     twin_coord_t max_h,
+                     twin_coord_t *out_w,
+                     twin_coord_t *out_h)
+{
+    uint32_t w = width, h = height;
+
+    if (max_w <= 0)
+        max_w = INT16_MAX;
+    if (max_h <= 0)
+        max_h = INT16_MAX;
+
+    /* Shrink to the tighter bound, keeping the aspect ratio */
+    if (w > (uint32_t) max_w || h > (uint32_t) max_h) {
+        if ((uint64_t) w * max_h > (uint64_t) h * max_w) {
+            h = ((uint64_t) h * max_w + w / 2) / w;
+            w = max_w;
+        } else {
+            w = ((uint64_t) w * max_h + h / 2) / h;
+            h = max_h;
+        }
+    }
+    *out_w = w ? w : 1;
+    *out_h = h ? h : 1;
+}
+
+/*
+ * Box-filter downscaling of streamed rows. Each source pixel is assigned
+ * to the output pixel covering its top-left corner, and every output
+ * pixel is the mean of the source pixels assigned to it, so only one
+ * output row of sums is live while the source streams through.
+ */
+bool _twin_image_scaler_init(twin_image_scaler_t *s,
+                             twin_pixmap_t *dst,
+                             uint32_t src_width,
+                             uint32_t src_height)
+{
+    *s = (twin_image_scaler_t){
+        .dst = dst,
+        .src_width = src_width,
+        .src_height = src_height,
+        .channels = dst->format == TWIN_RGB16
+                        ? 4
+                        : twin_bytes_per_pixel(dst->format),
+    };
+    s->sum = twin_calloc((size_t) dst->width * s->channels, sizeof(*s->sum));
+    s->span = twin_calloc(dst->width, sizeof(*s->span));
+    s->column = twin_malloc((size_t) src_width * sizeof(*s->column));
+    if (!s->sum || !s->span || !s->column) {
+        _twin_image_scaler_fini(s);
+        return false;
+    }
+    for (uint32_t x = 0; x < src_width; x++) {
+        s->column[x] = (uint64_t) x * dst->width / src_width;
+        s->span[s->column[x]]++;
+    }
+    return true;
+}
+
+static void _twin_image_scaler_flush(twin_image_scaler_t *s)
+{
+    twin_pixmap_t *dst = s->dst;
+    uint8_t *out = dst->p.b + s->dst_y * dst->stride;
+
+    if (!s->rows)
+        return;
+    for (twin_coord_t x = 0; x < dst->width; x++) {
+        uint64_t n = (uint64_t) s->span[x] * s->rows;
+        uint64_t *sum = s->sum + x * s->channels;
+
+        if (dst->format == TWIN_RGB16) {
+            /* Average in ARGB32 and pack once per output pixel */
+            twin_argb32_t v;
+            uint8_t *b = (uint8_t *) &v;
+            for (int c = 0; c < 4; c++) {
+                b[c] = (sum[c] + n / 2) / n;
+                sum[c] = 0;
+            }
+            ((twin_rgb16_t *) out)[x] = twin_argb32_to_rgb16(v);
+            continue;
+        }
+        for (int c = 0; c < s->channels; c++) {
+            *out++ = (sum[c] + n / 2) / n;
+            sum[c] = 0;
+        }
+    }
+    s->rows = 0;
+}
+
+void _twin_image_scaler_row(twin_image_scaler_t *s, const uint8_t *row)
+{
+    twin_coord_t dst_y;
+
+    if (s->src_y >= s->src_height)
+        return;
+    dst_y = (uint64_t) s->src_y * s->dst->height / s->src_height;
+    if (dst_y != s->dst_y) {
+        _twin_image_scaler_flush(s);
+        s->dst_y = dst_y;
+    }
+
+    if (s->channels == 4) {
+        for (uint32_t x = 0; x < s->src_width; x++, row += 4) {
+            uint64_t *sum = s->sum + s->column[x] * 4;
+            sum[0] += row[0];
+            sum[1] += row[1];
+            sum[2] += row[2];
+            sum[3] += row[3];
+        }
+    } else if (s->channels == 1) {
+        for (uint32_t x = 0; x < s->src_width; x++)
+            s->sum[s->column[x]] += row[x];
+    } else {
+        for (uint32_t x = 0; x < s->src_width; x++, row += s->channels)
+            for (int c = 0; c < s->channels; c++)
+                s->sum[s->column[x] * s->channels + c] += row[c];
+    }
+    s->rows++;
+
+    if (++s->src_y == s->src_height)
+        _twin_image_scaler_flush(s);
+}
+
+void _twin_image_scaler_fini(twin_image_scaler_t *s)
+{
+    twin_free(s->sum);
+    twin_free(s->span);
+    twin_free(s->column);
+    s->sum = NULL;
+    s->span = NULL;
+    s->column = NULL;
 }
@@ -53,8 +53,8 @@ static void _twin_label_paint(twin_label_t *label)
         }
         x += label->offset.x;
         twin_path_move(path, x, y);
-        twin_path_utf8(path, label->label);
-        twin_paint_path(label->widget.window->pixmap, label->foreground, path);
+        twin_paint_utf8(label->widget.window->pixmap, label->foreground, path,
+                        label->label);
         twin_path_destroy(path);
     }
 }
@@ -469,6 +469,18 @@ static uint8_t pool_storage[CONFIG_MEM_TLSF_POOL_SIZE]
 static tlsf_t tlsf_instance;
 static bool pool_ready;
 
+#if defined(CONFIG_LOADER_ASYNC)
+#include <pthread.h>
+
+/* Image decoding threads share the pool with the UI thread */
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+#define POOL_LOCK() pthread_mutex_lock(&pool_lock)
+#define POOL_UNLOCK() pthread_mutex_unlock(&pool_lock)
+#else
+#define POOL_LOCK() ((void) 0)
+#define POOL_UNLOCK() ((void) 0)
+#endif
+
 static bool twin_mem_pool_ensure_ready(void)
 {
     if (!pool_ready)
@@ -478,18 +490,22 @@ static bool twin_mem_pool_ensure_ready(void)
 
 void twin_mem_pool_init(void)
 {
-    if (pool_ready)
-        return;
-    size_t usable =
-        tlsf_pool_init(&tlsf_instance, pool_storage, sizeof(pool_storage));
-    pool_ready = (usable > 0);
+    POOL_LOCK();
+    if (!pool_ready) {
+        size_t usable =
+            tlsf_pool_init(&tlsf_instance, pool_storage, sizeof(pool_storage));
+        pool_ready = (usable > 0);
+    }
+    POOL_UNLOCK();
 }
 
 void *twin_raw_malloc(size_t size)
 {
     if (!twin_mem_pool_ensure_ready())
         return NULL;
+    POOL_LOCK();
     void *ptr = tlsf_malloc(&tlsf_instance, size);
+    POOL_UNLOCK();
     if (!ptr)
         log_error(
             "TLSF pool exhausted (requested %zu bytes, pool %d bytes). "
@@ -505,7 +521,9 @@ void *twin_raw_calloc(size_t n, size_t size)
     if (!twin_mem_pool_ensure_ready())
         return NULL;
     size_t total = n * size;
+    POOL_LOCK();
     void *ptr = tlsf_malloc(&tlsf_instance, total);
+    POOL_UNLOCK();
     if (ptr)
         memset(ptr, 0, total);
     return ptr;
@@ -515,12 +533,17 @@ void *twin_raw_realloc(void *ptr, size_t size)
 {
     if (!ptr && !twin_mem_pool_ensure_ready())
         return NULL;
-    return tlsf_realloc(&tlsf_instance, ptr, size);
+    POOL_LOCK();
+    void *mem = tlsf_realloc(&tlsf_instance, ptr, size);
+    POOL_UNLOCK();
+    return mem;
 }
 
 void twin_raw_free(void *ptr)
 {
+    POOL_LOCK();
     tlsf_free(&tlsf_instance, ptr);
+    POOL_UNLOCK();
 }
 
 #endif /* CONFIG_MEM_TLSF */
@@ -36,6 +36,18 @@ static size_t memtbl_capacity = MEMTBL_INLINE_CAPACITY;
 
 static twin_memstats_t stats;
 
+#if defined(CONFIG_LOADER_ASYNC)
+#include <pthread.h>
+
+/* Image decoding threads allocate too; serialize the table and counters */
+static pthread_mutex_t memtbl_lock = PTHREAD_MUTEX_INITIALIZER;
+#define MEMTBL_LOCK() pthread_mutex_lock(&memtbl_lock)
+#define MEMTBL_UNLOCK() pthread_mutex_unlock(&memtbl_lock)
+#else
+#define MEMTBL_LOCK() ((void) 0)
+#define MEMTBL_UNLOCK() ((void) 0)
+#endif
+
 static bool memtbl_grow(void)
 {
     size_t new_capacity;
@@ -114,7 +126,9 @@ void *_twin_malloc(size_t size, const char *file, int line)
     (void) line;
     void *ptr = twin_raw_malloc(size);
     if (ptr) {
+        MEMTBL_LOCK();
         if (!memtbl_insert(ptr, size)) {
+            MEMTBL_UNLOCK();
             twin_raw_free(ptr);
             return NULL;
         }
@@ -123,6 +137,7 @@ void *_twin_malloc(size_t size, const char *file, int line)
             stats.peak_bytes = stats.current_bytes;
         stats.total_bytes += size;
         stats.total_allocs++;
+        MEMTBL_UNLOCK();
     }
     return ptr;
 }
@@ -137,7 +152,9 @@ void *_twin_calloc(size_t n, size_t size, const char *file, int line)
     void *ptr = twin_raw_calloc(n, size);
     if (ptr) {
         size_t total = n * size;
+        MEMTBL_LOCK();
         if (!memtbl_insert(ptr, total)) {
+            MEMTBL_UNLOCK();
             twin_raw_free(ptr);
             return NULL;
         }
@@ -146,6 +163,7 @@ void *_twin_calloc(size_t n, size_t size, const char *file, int line)
             stats.peak_bytes = stats.current_bytes;
         stats.total_bytes += total;
         stats.total_allocs++;
+        MEMTBL_UNLOCK();
     }
     return ptr;
 }
@@ -155,22 +173,29 @@ void *_twin_realloc(void *old, size_t size, const char *file, int line)
     (void) file;
     (void) line;
 
+    MEMTBL_LOCK();
     if (size == 0) {
         size_t old_size = memtbl_remove(old);
         stats.current_bytes -= old_size;
         if (old)
             stats.total_frees++;
+        MEMTBL_UNLOCK();
         twin_raw_free(old);
         return NULL;
     }
 
+    /* Held across the realloc so the entry for @old stays at old_idx */
     ptrdiff_t old_idx = old ? memtbl_find(old) : -1;
-    if (old_idx < 0 && memtbl_count == memtbl_capacity && !memtbl_grow())
+    if (old_idx < 0 && memtbl_count == memtbl_capacity && !memtbl_grow()) {
+        MEMTBL_UNLOCK();
         return NULL;
+    }
 
     void *ptr = twin_raw_realloc(old, size);
-    if (!ptr)
+    if (!ptr) {
+        MEMTBL_UNLOCK();
         return NULL;
+    }
 
     if (old_idx >= 0) {
         size_t old_size = memtbl[old_idx].size;
@@ -180,8 +205,10 @@ void *_twin_realloc(void *old, size_t size, const char *file, int line)
     } else {
         bool inserted = memtbl_insert(ptr, size);
         assert(inserted && "memtbl_insert should succeed after pre-growing");
-        if (!inserted)
+        if (!inserted) {
+            MEMTBL_UNLOCK();
             return ptr;
+        }
     }
 
     stats.current_bytes += size;
@@ -191,6 +218,7 @@ void *_twin_realloc(void *old, size_t size, const char *file, int line)
     stats.total_allocs++;
     if (old)
         stats.total_frees++;
+    MEMTBL_UNLOCK();
     return ptr;
 }
 
@@ -200,9 +228,11 @@ void _twin_free(void *ptr, const char *file, int line)
     (void) line;
     if (!ptr)
         return;
+    MEMTBL_LOCK();
     size_t sz = memtbl_remove(ptr);
     stats.current_bytes -= sz;
     stats.total_frees++;
+    MEMTBL_UNLOCK();
     twin_raw_free(ptr);
 }
 
@@ -210,15 +240,19 @@ void twin_memory_get_info(twin_memory_info_t *info)
 {
     if (!info)
         return;
+    MEMTBL_LOCK();
     info->current_bytes = stats.current_bytes;
     info->peak_bytes = stats.peak_bytes;
     info->total_allocs = stats.total_allocs;
     info->total_frees = stats.total_frees;
+    MEMTBL_UNLOCK();
 }
 
 void twin_memory_reset_peak(void)
 {
+    MEMTBL_LOCK();
     stats.peak_bytes = stats.current_bytes;
+    MEMTBL_UNLOCK();
 }
 
 #else /* !CONFIG_MEMORY_STATS */
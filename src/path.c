@@ -89,6 +89,53 @@ void _twin_path_smove(twin_path_t *path, twin_sfixed_t x, twin_sfixed_t y)
     }
 }
 
+bool _twin_path_reserve(twin_path_t *path, int npoints, int nsublen)
+{
+    int size_points = path->size_points;
+    int size_sublen = path->size_sublen;
+
+    while (path->npoints + npoints > size_points)
+        size_points *= 2;
+    if (size_points != path->size_points) {
+        twin_spoint_t *points;
+
+        if (path->points == path->inline_points) {
+            points = twin_malloc(size_points * sizeof(twin_spoint_t));
+            if (!points)
+                return false;
+            memcpy(points, path->inline_points,
+                   path->npoints * sizeof(twin_spoint_t));
+        } else {
+            points =
+                twin_realloc(path->points, size_points * sizeof(twin_spoint_t));
+            if (!points)
+                return false;
+        }
+        path->points = points;
+        path->size_points = size_points;
+    }
+
+    while (path->nsublen + nsublen > size_sublen)
+        size_sublen *= 2;
+    if (size_sublen != path->size_sublen) {
+        int *sublen;
+
+        if (path->sublen == path->inline_sublen) {
+            sublen = twin_malloc(size_sublen * sizeof(int));
+            if (!sublen)
+                return false;
+            memcpy(sublen, path->inline_sublen, path->nsublen * sizeof(int));
+        } else {
+            sublen = twin_realloc(path->sublen, size_sublen * sizeof(int));
+            if (!sublen)
+                return false;
+        }
+        path->sublen = sublen;
+        path->size_sublen = size_sublen;
+    }
+    return true;
+}
+
 void _twin_path_sdraw(twin_path_t *path, twin_sfixed_t x, twin_sfixed_t y)
 {
     if (_twin_current_subpath_len(path) > 0 &&
@@ -696,6 +743,7 @@ void twin_composite_path(twin_pixmap_t *dst,
         mask->width = width;
         mask->height = height;
         twin_matrix_identity(&mask->transform);
+        mask->filter = TWIN_FILTER_BILINEAR;
         mask->clip.left = mask->clip.top = 0;
         mask->clip.right = width;
         mask->clip.bottom = height;
@@ -706,9 +754,11 @@ void twin_composite_path(twin_pixmap_t *dst,
 #if defined(CONFIG_DROP_SHADOW)
         mask->shadow = false;
 #endif
+        mask->opacity = 0xff;
         mask->window = NULL;
         mask->xform_cache = NULL;
         mask->xform_cache_size = 0;
+        mask->image_cache = NULL;
         mask->p.v = mask + 1;
     } else {
         /* Try the screen's reusable mask cache before a fresh alloc.
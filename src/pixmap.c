@@ -75,6 +75,7 @@ twin_pixmap_t *twin_pixmap_create(twin_format_t format,
     pixmap->width = width;
     pixmap->height = height;
     twin_matrix_identity(&pixmap->transform);
+    pixmap->filter = TWIN_FILTER_BILINEAR;
     pixmap->clip.left = pixmap->clip.top = 0;
     pixmap->clip.right = pixmap->width;
     pixmap->clip.bottom = pixmap->height;
@@ -83,9 +84,11 @@ twin_pixmap_t *twin_pixmap_create(twin_format_t format,
     pixmap->disable = 0;
     pixmap->animation = NULL;
     pixmap->shadow = false;
+    pixmap->opacity = 0xff;
     pixmap->window = NULL; /* Initialize window field */
     pixmap->xform_cache = NULL;
     pixmap->xform_cache_size = 0;
+    pixmap->image_cache = NULL;
     pixmap->p.v = pixmap + 1;
     memset(pixmap->p.v, '\0', space);
     return pixmap;
@@ -155,15 +158,20 @@ twin_pixmap_t *twin_pixmap_create_const(twin_format_t format,
     pixmap->width = width;
     pixmap->height = height;
     twin_matrix_identity(&pixmap->transform);
+    pixmap->filter = TWIN_FILTER_BILINEAR;
     pixmap->clip.left = pixmap->clip.top = 0;
     pixmap->clip.right = pixmap->width;
     pixmap->clip.bottom = pixmap->height;
     pixmap->origin_x = pixmap->origin_y = 0;
     pixmap->stride = stride;
     pixmap->disable = 0;
+    pixmap->animation = NULL;
+    pixmap->shadow = false;
+    pixmap->opacity = 0xff;
     pixmap->window = NULL; /* Initialize window field */
     pixmap->xform_cache = NULL;
     pixmap->xform_cache_size = 0;
+    pixmap->image_cache = NULL;
     pixmap->p = pixels;
     return pixmap;
 }
@@ -173,6 +181,9 @@ void twin_pixmap_destroy(twin_pixmap_t *pixmap)
     if (pixmap->screen)
         twin_pixmap_hide(pixmap);
     twin_pixmap_reset_xform_cache(pixmap);
+#if defined(CONFIG_RENDERER_PIXMAN)
+    twin_pixman_image_release(pixmap);
+#endif
     twin_free(pixmap);
 }
 
@@ -186,6 +197,20 @@ void twin_pixmap_reset_xform_cache(twin_pixmap_t *pixmap)
     pixmap->xform_cache_size = 0;
 }
 
+/* Damage everything the pixmap covers on screen, drop shadow included. */
+static void twin_pixmap_damage_footprint(twin_pixmap_t *pixmap)
+{
+    twin_coord_t right = pixmap->width, bottom = pixmap->height;
+
+#if defined(CONFIG_DROP_SHADOW)
+    if (pixmap->shadow && pixmap->window) {
+        right += pixmap->window->shadow_x;
+        bottom += pixmap->window->shadow_y;
+    }
+#endif
+    twin_pixmap_damage(pixmap, 0, 0, right, bottom);
+}
+
 void twin_pixmap_show(twin_pixmap_t *pixmap,
                       twin_screen_t *screen,
                       twin_pixmap_t *lower)
@@ -215,7 +240,7 @@ void twin_pixmap_show(twin_pixmap_t *pixmap,
             screen->top = pixmap;
     }
 
-    twin_pixmap_damage(pixmap, 0, 0, pixmap->width, pixmap->height);
+    twin_pixmap_damage_footprint(pixmap);
 }
 
 void twin_pixmap_hide(twin_pixmap_t *pixmap)
@@ -226,7 +251,7 @@ void twin_pixmap_hide(twin_pixmap_t *pixmap)
     if (!screen)
         return;
 
-    twin_pixmap_damage(pixmap, 0, 0, pixmap->width, pixmap->height);
+    twin_pixmap_damage_footprint(pixmap);
 
     if (pixmap->up)
         down = &pixmap->up->down;
@@ -436,12 +461,30 @@ bool twin_pixmap_is_iconified(twin_pixmap_t *pixmap, twin_coord_t y)
 
 void twin_pixmap_move(twin_pixmap_t *pixmap, twin_coord_t x, twin_coord_t y)
 {
-    twin_pixmap_damage(pixmap, 0, 0, pixmap->width, pixmap->height);
+    twin_pixmap_damage_footprint(pixmap);
     pixmap->x = x;
     pixmap->y = y;
+    twin_pixmap_damage_footprint(pixmap);
+}
+
+void twin_pixmap_set_opacity(twin_pixmap_t *pixmap, twin_a8_t opacity)
+{
+    if (pixmap->opacity == opacity)
+        return;
+    pixmap->opacity = opacity;
     twin_pixmap_damage(pixmap, 0, 0, pixmap->width, pixmap->height);
 }
 
+twin_a8_t twin_pixmap_get_opacity(twin_pixmap_t *pixmap)
+{
+    return pixmap->opacity;
+}
+
+void twin_pixmap_set_filter(twin_pixmap_t *pixmap, twin_filter_t filter)
+{
+    pixmap->filter = filter;
+}
+
 bool twin_pixmap_dispatch(twin_pixmap_t *pixmap, twin_event_t *event)
 {
     if (pixmap->window)
@@ -303,6 +303,11 @@ void twin_fill_path(twin_pixmap_t *pixmap,
     twin_sfixed_t sdx = twin_int_to_sfixed(dx + pixmap->origin_x);
     twin_sfixed_t sdy = twin_int_to_sfixed(dy + pixmap->origin_y);
 
+#if defined(CONFIG_PIXMAN_RASTERIZER)
+    if (twin_pixman_fill_path(pixmap, path, sdx, sdy))
+        return;
+#endif
+
     int nalloc = path->npoints + path->nsublen + 1;
     size_t edge_bytes = sizeof(twin_edge_t) * nalloc;
     bool from_scratch = false;
@@ -45,7 +45,9 @@ void _twin_rgb16_source_argb32(twin_pointer_t dst, twin_source_u src, int width)
 {
     twin_argb32_t src32;
     while (width--) {
-        src32 = twin_rgb16_to_argb32(*src.p.rgb16++);
+        uint16_t src16 = *src.p.rgb16++;
+
+        src32 = twin_rgb16_to_argb32(src16);
         *dst.argb32++ = src32;
     }
 }
@@ -80,3 +82,98 @@ void _twin_argb32_source_argb32(twin_pointer_t dst,
         *dst.argb32++ = src32;
     }
 }
+
+/*
+ * Constant-alpha kernels.
+ *
+ * These fold a global opacity (carried in the top byte of msk.c, as with
+ * the generated 'c' mask kernels) into the over loop.  Pixels are handled
+ * two channels per multiply: red/blue and alpha/green each sit in a 0x00ff00ff
+ * lane pair, so IN and OVER cost two multiplies each instead of four.  The
+ * rounding matches twin_int_mult() exactly, so results are bit-identical to
+ * the generic in_over() path.
+ */
+#define TWIN_RB_MASK 0x00ff00ff
+#define TWIN_RB_HALF 0x00800080
+
+static inline uint32_t _twin_lanes_mult(uint32_t lanes, uint16_t a)
+{
+    uint32_t t = lanes * a + TWIN_RB_HALF;
+
+    return ((t + ((t >> 8) & TWIN_RB_MASK)) >> 8) & TWIN_RB_MASK;
+}
+
+static inline uint32_t _twin_lanes_sat(uint32_t lanes)
+{
+    lanes |= 0x01000100 - ((lanes >> 8) & 0x00010001);
+    return lanes & TWIN_RB_MASK;
+}
+
+static inline twin_argb32_t _twin_in_alpha(twin_argb32_t src, uint16_t a)
+{
+    return _twin_lanes_mult(src & TWIN_RB_MASK, a) |
+           (_twin_lanes_mult((src >> 8) & TWIN_RB_MASK, a) << 8);
+}
+
+static inline twin_argb32_t _twin_over_lanes(twin_argb32_t dst,
+                                             twin_argb32_t src)
+{
+    uint16_t ia = 0xff - (src >> 24);
+    uint32_t rb, ag;
+
+    if (!ia)
+        return src;
+    rb = _twin_lanes_mult(dst & TWIN_RB_MASK, ia) + (src & TWIN_RB_MASK);
+    ag = _twin_lanes_mult((dst >> 8) & TWIN_RB_MASK, ia) +
+         ((src >> 8) & TWIN_RB_MASK);
+    return _twin_lanes_sat(rb) | (_twin_lanes_sat(ag) << 8);
+}
+
+/*
+ * ARGB32 source scaled by a constant alpha, composited OVER ARGB32
+ * Used for translucent screen layers and twin_composite_alpha()
+ */
+void _twin_argb32_in_alpha_over_argb32(twin_pointer_t dst,
+                                       twin_source_u src,
+                                       twin_source_u msk,
+                                       int width)
+{
+    uint16_t a = msk.c >> 24;
+    twin_argb32_t src32;
+
+    while (width--) {
+        src32 = *src.p.argb32++;
+        if (src32) {
+            src32 = _twin_in_alpha(src32, a);
+            *dst.argb32 = _twin_over_lanes(*dst.argb32, src32);
+        }
+        dst.argb32++;
+    }
+}
+
+/*
+ * RGB16 source scaled by a constant alpha, composited OVER ARGB32
+ * The source is opaque, so the OVER factor is the same for every pixel.
+ */
+void _twin_rgb16_in_alpha_over_argb32(twin_pointer_t dst,
+                                      twin_source_u src,
+                                      twin_source_u msk,
+                                      int width)
+{
+    uint16_t a = msk.c >> 24;
+    uint16_t ia = 0xff - a;
+    twin_argb32_t src32, dst32;
+
+    while (width--) {
+        uint16_t src16 = *src.p.rgb16++;
+
+        src32 = _twin_in_alpha(twin_rgb16_to_argb32(src16), a);
+        dst32 = *dst.argb32;
+        *dst.argb32++ =
+            _twin_lanes_sat(_twin_lanes_mult(dst32 & TWIN_RB_MASK, ia) +
+                            (src32 & TWIN_RB_MASK)) |
+            (_twin_lanes_sat(_twin_lanes_mult((dst32 >> 8) & TWIN_RB_MASK, ia) +
+                             ((src32 >> 8) & TWIN_RB_MASK))
+             << 8);
+    }
+}
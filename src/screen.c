@@ -41,6 +41,7 @@ twin_screen_t *twin_screen_create(twin_coord_t width,
     screen->closure = closure;
 
     screen->button_x = screen->button_y = -1;
+    screen->shadow = NULL;
     screen->span_cache = NULL;
     screen->span_cache_width = 0;
 
@@ -61,6 +62,10 @@ void twin_screen_destroy(twin_screen_t *screen)
         twin_path_destroy(screen->path_cache[i]);
     if (screen->mask_cache)
         twin_pixmap_destroy(screen->mask_cache);
+#if defined(CONFIG_DROP_SHADOW)
+    if (screen->shadow)
+        twin_shadow_patch_release(screen->shadow);
+#endif
     twin_free(screen->span_cache);
     twin_free(screen->scratch_buf);
     twin_free(screen);
@@ -152,6 +157,10 @@ static void twin_screen_span_pixmap(twin_screen_t maybe_unused *screen,
     twin_source_u src;
     twin_coord_t p_left, p_right;
 
+    /* fully transparent layers contribute nothing */
+    if (!p->opacity)
+        return;
+
     /* bounds check in y */
     if (y < p->y)
         return;
@@ -169,12 +178,78 @@ static void twin_screen_span_pixmap(twin_screen_t maybe_unused *screen,
         return;
     dst.argb32 = span + (p_left - left);
     src.p = twin_pixmap_pointer(p, p_left - p->x, y - p->y);
+    if (p->opacity != 0xff) {
+        twin_source_u msk = {.c = (twin_argb32_t) p->opacity << 24};
+
+        if (p->format == TWIN_RGB16)
+            _twin_rgb16_in_alpha_over_argb32(dst, src, msk, p_right - p_left);
+        else
+            _twin_argb32_in_alpha_over_argb32(dst, src, msk, p_right - p_left);
+        return;
+    }
     if (p->format == TWIN_RGB16)
         op16(dst, src, p_right - p_left);
     else
         op32(dst, src, p_right - p_left);
 }
 
+#if defined(CONFIG_DROP_SHADOW)
+/* Composite the shared shadow layer beneath a shadowed window's row. */
+static void twin_screen_span_shadow(twin_screen_t *screen,
+                                    twin_argb32_t *span,
+                                    twin_pixmap_t *p,
+                                    twin_coord_t y,
+                                    twin_coord_t left,
+                                    twin_coord_t right,
+                                    twin_src_op op32)
+{
+    const twin_shadow_patch_t *patch = screen->shadow;
+    twin_argb32_t chunk[64];
+    twin_pointer_t dst;
+    twin_source_u src;
+    twin_argb32_t *row;
+    twin_coord_t win_w, win_h, width, height, sy, x0, x1;
+
+    if (!patch || !p->window || !p->opacity)
+        return;
+    /* The pixmap also holds the resize grip, which sits on the shadow */
+    win_w = p->width - TWIN_WINDOW_GRIP;
+    win_h = p->height - TWIN_WINDOW_GRIP;
+    width = win_w + p->window->shadow_x;
+    height = win_h + p->window->shadow_y;
+    sy = y - p->y;
+    if (sy < 0 || sy >= height)
+        return;
+
+    /* Beside the window only the right margin shows; below it, every column */
+    x0 = sy < win_h ? win_w : 0;
+    x1 = width;
+    if (x0 < left - p->x)
+        x0 = left - p->x;
+    if (x1 > right - p->x)
+        x1 = right - p->x;
+
+    row = twin_pixmap_pointer(patch->pixmap, 0,
+                              _twin_ninepatch_map(sy, height,
+                                                  patch->pixmap->height,
+                                                  patch->top, patch->bottom))
+              .argb32;
+    src.p.argb32 = chunk;
+    while (x0 < x1) {
+        twin_coord_t n = x1 - x0;
+        if (n > (twin_coord_t) (sizeof(chunk) / sizeof(chunk[0])))
+            n = sizeof(chunk) / sizeof(chunk[0]);
+        for (twin_coord_t i = 0; i < n; i++)
+            chunk[i] = row[_twin_ninepatch_map(x0 + i, width,
+                                               patch->pixmap->width,
+                                               patch->left, patch->right)];
+        dst.argb32 = span + (p->x + x0 - left);
+        op32(dst, src, n);
+        x0 += n;
+    }
+}
+#endif
+
 void twin_screen_update(twin_screen_t *screen)
 {
     twin_coord_t left = screen->damage.left;
@@ -242,9 +317,15 @@ void twin_screen_update(twin_screen_t *screen)
 
             for (p = screen->bottom; p; p = p->up) {
                 /* Skip drawing the region of the iconified pixmap. */
-                if (!twin_pixmap_is_iconified(p, y))
-                    twin_screen_span_pixmap(screen, span, p, y, left, right,
-                                            pop16, pop32);
+                if (twin_pixmap_is_iconified(p, y))
+                    continue;
+#if defined(CONFIG_DROP_SHADOW)
+                if (p->shadow)
+                    twin_screen_span_shadow(screen, span, p, y, left, right,
+                                            pop32);
+#endif
+                twin_screen_span_pixmap(screen, span, p, y, left, right, pop16,
+                                        pop32);
             }
 
 #if defined(CONFIG_CURSOR)
@@ -0,0 +1,30 @@
+/*
+ * This file is auto-generated by scripts/gen-shadow-lut.py.
+ * Do not edit manually.
+ */
+#ifndef SHADOW_GAUSSIAN_LUT_H
+#define SHADOW_GAUSSIAN_LUT_H
+
+#include "twin.h"
+
+static const twin_fixed_t shadow_gaussian_lut[17] = {
+    0x10000,
+    0x0fe2a,
+    0x0f8b3,
+    0x0efbb,
+    0x0e37b,
+    0x0d43f,
+    0x0c26b,
+    0x0ae78,
+    0x098f6,
+    0x0828a,
+    0x06bf0,
+    0x055fa,
+    0x0418f,
+    0x02fae,
+    0x0216b,
+    0x017ef,
+    0x0147b
+};
+
+#endif /* SHADOW_GAUSSIAN_LUT_H */
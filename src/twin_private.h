@@ -336,13 +336,6 @@ static inline twin_xfixed_t _twin_xfixed_div_32bit(twin_xfixed_t a,
     (((t) = twin_get_8(d, i) + twin_get_8(s, i)), (twin_argb32_t) twin_sat(t) \
                                                       << (i))
 
-#define _twin_add_ARGB(s, d, i, t) (((t) = (s) + twin_get_8(d, i)))
-#define _twin_add(s, d, t) (((t) = (s) + (d)))
-#define _twin_div(d, den, i, t)                     \
-    (((t) = (d) / (den)), (t) = twin_get_8((t), 0), \
-     (twin_argb32_t) twin_sat(t) << (i))
-#define _twin_sub_ARGB(s, d, i, t) (((t) = (s) - twin_get_8(d, i)))
-#define _twin_sub(s, d, t) (((t) = (s) - (d)))
 #define twin_put_8(d, i, t) (((t) = (d) << (i)))
 
 #define twin_argb32_to_rgb16(s) \
@@ -393,6 +386,31 @@ typedef void (*twin_src_msk_op)(twin_pointer_t dst,
 
 typedef void (*twin_src_op)(twin_pointer_t dst, twin_source_u src, int width);
 
+/*
+ * Transform classes, decided once per composite from the matrix and the
+ * pixmap filter.  Integer translations fetch rows directly; axis-aligned
+ * scales reuse a per-column table of source indices and weights for every
+ * row.
+ */
+typedef enum {
+    TWIN_XFORM_GENERAL,
+    TWIN_XFORM_NEAREST,
+    TWIN_XFORM_TRANSLATE,
+    TWIN_XFORM_SCALE,
+    TWIN_XFORM_SCALE_NEAREST,
+    TWIN_XFORM_BOX,
+} twin_xform_kind_t;
+
+/*
+ * Bilinear: source columns x0 and x0 + 1 (-1 when clipped), weight of x1.
+ * Nearest: x0 only.  Box: clipped column range [x0, x1), wx is the
+ * unclipped box width used as divisor.
+ */
+typedef struct _twin_xform_col {
+    int32_t x0, x1;
+    uint32_t wx;
+} twin_xform_col_t;
+
 typedef struct _twin_xform {
     twin_pixmap_t *pixmap;
     twin_pointer_t span;
@@ -400,6 +418,8 @@ typedef struct _twin_xform {
     twin_coord_t width;
     twin_coord_t src_x;
     twin_coord_t src_y;
+    twin_xform_kind_t kind;
+    twin_xform_col_t *cols; /* TWIN_XFORM_SCALE only */
 } twin_xform_t;
 
 /* twin_primitive.c */
@@ -517,6 +537,9 @@ void _twin_path_smove(twin_path_t *path, twin_sfixed_t x, twin_sfixed_t y);
 
 void _twin_path_sdraw(twin_path_t *path, twin_sfixed_t x, twin_sfixed_t y);
 
+/* Grow storage for @npoints more points and @nsublen more subpaths */
+bool _twin_path_reserve(twin_path_t *path, int npoints, int nsublen);
+
 void _twin_path_scurve(twin_path_t *path,
                        twin_sfixed_t x1,
                        twin_sfixed_t y1,
@@ -546,6 +569,29 @@ void _twin_path_sfinish(twin_path_t *path);
 #define twin_glyph_snap_x(g) (&g[6])
 #define twin_glyph_snap_y(g) (twin_glyph_snap_x(g) + twin_glyph_n_snap_x(g))
 
+/*
+ * Unicode page index
+ *
+ * A two-level table maps every page of the Unicode code space to its
+ * charmap entry: the top level selects a block of TWIN_PAGE_BLOCK pages,
+ * the block holds charmap indices plus one, with zero marking a page the
+ * font lacks. Blocks no charmap page falls in share the all-zero block 0,
+ * so a Latin-only font needs two blocks and a CJK font a handful more.
+ * Built on first use for compiled-in fonts; font files carry it verbatim.
+ */
+#define TWIN_PAGE_MAX (0x110000 >> UCS_PAGE_SHIFT)
+#define TWIN_PAGE_BLOCK_SHIFT 6
+#define TWIN_PAGE_BLOCK (1 << TWIN_PAGE_BLOCK_SHIFT)
+#define TWIN_PAGE_BLOCKS (TWIN_PAGE_MAX >> TWIN_PAGE_BLOCK_SHIFT)
+
+struct _twin_page_index {
+    uint16_t top[TWIN_PAGE_BLOCKS];
+    uint16_t blocks[][TWIN_PAGE_BLOCK];
+};
+
+/* Drop cached glyphs of @font before it goes away */
+void _twin_font_flush(const twin_font_t *font);
+
 /*
  * Dispatch stuff
  */
@@ -712,6 +758,73 @@ typedef struct twin_backend {
     void (*exit)(twin_context_t *ctx);
 } twin_backend_t;
 
+/*
+ * Animations whose frames are produced on demand rather than held in
+ * anim->frames. frame() brings the stream's canvas to frame @index and
+ * returns it, setting @damage to the area that changed; the canvas is
+ * updated in place by the next call. destroy() releases the stream.
+ */
+struct _twin_animation_stream {
+    twin_pixmap_t *(*frame)(twin_animation_stream_t *stream,
+                            twin_count_t index,
+                            twin_rect_t *damage);
+    void (*destroy)(twin_animation_stream_t *stream);
+};
+
+/*
+ * Image loader helpers
+ */
+
+/*
+ * Size of a @width x @height image fitted inside @max_w x @max_h with its
+ * aspect ratio kept; images that already fit are left at native size. A
+ * bound of zero or less leaves that axis unconstrained.
+ */
+void _twin_image_fit(uint32_t width,
+                     uint32_t height,
+                     twin_coord_t max_w,
+                     twin_coord_t max_h,
+                     twin_coord_t *out_w,
+                     twin_coord_t *out_h);
+
+/*
+ * Load a whole file for decoders that parse from memory: it is mapped, or
+ * read into a heap buffer where it cannot be. Returns NULL on failure;
+ * release the data with the @size and @mapped that were returned.
+ */
+const uint8_t *_twin_file_map(const char *path, size_t *size, bool *mapped);
+
+void _twin_file_unmap(const uint8_t *data, size_t size, bool mapped);
+
+/*
+ * Area-averaging reducer for loaders that decode row by row. Rows are fed
+ * top to bottom in the byte layout of the destination (TWIN_A8 or
+ * premultiplied TWIN_ARGB32; a TWIN_RGB16 destination takes ARGB32 rows)
+ * and each completed output row is written to @dst as soon as its last
+ * source row arrives. Sums are 64-bit: reducing a large image to a
+ * thumbnail can fold millions of source pixels into one output pixel.
+ */
+typedef struct _twin_image_scaler {
+    twin_pixmap_t *dst;
+    uint32_t src_width, src_height;
+    uint32_t src_y;       /* next source row */
+    twin_coord_t dst_y;   /* output row being accumulated */
+    uint32_t rows;        /* source rows summed into it */
+    int channels;         /* bytes per pixel */
+    uint64_t *sum;        /* per-byte sums of the output row */
+    uint32_t *span;       /* source columns per output column */
+    twin_coord_t *column; /* output column of each source column */
+} twin_image_scaler_t;
+
+bool _twin_image_scaler_init(twin_image_scaler_t *s,
+                             twin_pixmap_t *dst,
+                             uint32_t src_width,
+                             uint32_t src_height);
+
+void _twin_image_scaler_row(twin_image_scaler_t *s, const uint8_t *row);
+
+void _twin_image_scaler_fini(twin_image_scaler_t *s);
+
 /*
  * Visual effect stuff
  */
@@ -726,13 +839,67 @@ typedef struct twin_backend {
     (CONFIG_HORIZONTAL_OFFSET + TWIN_SHADOW_FADE_EXTENT)
 #define TWIN_SHADOW_EXTENT_Y (CONFIG_VERTICAL_OFFSET + TWIN_SHADOW_FADE_EXTENT)
 /*
- * Render a CSS-style drop shadow mask onto the pixmap's shadow region.
+ * Window pixmaps keep this much room past the right and bottom edges of the
+ * window for the resize grip, which hangs 0.2 of its TWIN_TITLE_HEIGHT size
+ * plus its outline off the corner of the client area.  The shadow layer
+ * shows through the rest of it.
+ */
+#define TWIN_WINDOW_GRIP 5
+/*
+ * Render a CSS-style drop shadow mask into the margin of a pixmap that is
+ * TWIN_SHADOW_EXTENT_X/Y larger than the window it shadows.
  * Offsets and blur are compile-time constants (CONFIG_HORIZONTAL_OFFSET,
  * CONFIG_VERTICAL_OFFSET, CONFIG_SHADOW_BLUR).  Requires ARGB32 format.
  */
-void twin_shadow_border(twin_pixmap_t *shadow, twin_argb32_t color);
+void twin_shadow_border(twin_pixmap_t *shadow,
+                        twin_window_style_t style,
+                        twin_argb32_t color);
+
+/*
+ * Nine-patch drop shadow: the blurred shadow of a prototype window with its
+ * margin.  Borders keep their size; the rows and columns between them are
+ * stretched to the size of the shadowed window.
+ */
+typedef struct _twin_shadow_patch {
+    twin_pixmap_t *pixmap;
+    twin_coord_t left, right, top, bottom; /* Fixed border sizes */
+} twin_shadow_patch_t;
+
+/*
+ * Look up the shared shadow patch for a window style, colour and blur
+ * radius, rendering and blurring it on first use.  The caller holds a
+ * reference until twin_shadow_patch_release(); held patches are never
+ * evicted.  Returns NULL when out of memory or every slot is held.
+ */
+const twin_shadow_patch_t *twin_shadow_patch(twin_window_style_t style,
+                                             twin_argb32_t color,
+                                             int blur);
+
+void twin_shadow_patch_release(const twin_shadow_patch_t *patch);
+#else
+#define TWIN_WINDOW_GRIP 0
 #endif
 
+/*
+ * Map a destination coordinate of a nine-patch stretched to size onto a
+ * source of src_size: the head and tail borders copy straight across, the
+ * middle is stretched.
+ */
+static inline twin_coord_t _twin_ninepatch_map(twin_coord_t v,
+                                               twin_coord_t size,
+                                               twin_coord_t src_size,
+                                               twin_coord_t head,
+                                               twin_coord_t tail)
+{
+    if (v >= size - tail)
+        return v - size + src_size;
+    if (v < head)
+        return v;
+    return head + (twin_coord_t) ((int32_t) (v - head) *
+                                  (src_size - head - tail) /
+                                  (size - head - tail));
+}
+
 /* utility */
 
 #ifdef _MSC_VER
@@ -865,6 +1032,15 @@ twin_pointer_t twin_pixmap_pointer(twin_pixmap_t *pixmap,
                                    twin_coord_t x,
                                    twin_coord_t y);
 void twin_pixmap_reset_xform_cache(twin_pixmap_t *pixmap);
+#if defined(CONFIG_RENDERER_PIXMAN)
+void twin_pixman_image_release(twin_pixmap_t *pixmap);
+#endif
+#if defined(CONFIG_PIXMAN_RASTERIZER)
+bool twin_pixman_fill_path(twin_pixmap_t *pixmap,
+                           twin_path_t *path,
+                           twin_sfixed_t dx,
+                           twin_sfixed_t dy);
+#endif
 void twin_pixmap_origin_to_clip(twin_pixmap_t *pixmap);
 void twin_pixmap_offset(twin_pixmap_t *pixmap,
                         twin_coord_t offx,
@@ -175,13 +175,14 @@ bool _twin_widget_contains(twin_widget_t *widget,
             y < _twin_widget_height(widget));
 }
 
-void _twin_widget_bevel(twin_widget_t *widget, twin_fixed_t b, bool down)
+static void _twin_bevel_paint(twin_pixmap_t *pixmap,
+                              twin_fixed_t w,
+                              twin_fixed_t h,
+                              twin_fixed_t b,
+                              bool down)
 {
     twin_path_t *path = twin_path_create();
-    twin_fixed_t w = twin_int_to_fixed(_twin_widget_width(widget));
-    twin_fixed_t h = twin_int_to_fixed(_twin_widget_height(widget));
     twin_argb32_t top_color, bot_color;
-    twin_pixmap_t *pixmap = widget->window->pixmap;
 
     if (path) {
         if (down) {
@@ -213,6 +214,68 @@ void _twin_widget_bevel(twin_widget_t *widget, twin_fixed_t b, bool down)
     }
 }
 
+/*
+ * Bevels rendered once at their smallest size, a border of ceil(b) pixels
+ * around a single stretchable pixel, and stretched onto each widget.
+ */
+#define TWIN_BEVEL_CACHE_SIZE 4
+
+static struct {
+    twin_fixed_t b;
+    bool down;
+    twin_pixmap_t *pixmap;
+} bevel_cache[TWIN_BEVEL_CACHE_SIZE];
+static int bevel_cache_next;
+
+static twin_pixmap_t *_twin_bevel_lookup(twin_fixed_t b, bool down)
+{
+    twin_coord_t border = twin_fixed_to_int(twin_fixed_ceil(b));
+    twin_coord_t size = 2 * border + 1;
+    twin_pixmap_t *pixmap;
+    int i;
+
+    for (i = 0; i < TWIN_BEVEL_CACHE_SIZE; i++) {
+        if (bevel_cache[i].pixmap && bevel_cache[i].b == b &&
+            bevel_cache[i].down == down)
+            return bevel_cache[i].pixmap;
+    }
+
+    pixmap = twin_pixmap_create(TWIN_ARGB32, size, size);
+    if (!pixmap)
+        return NULL;
+    twin_fill(pixmap, 0x00000000, TWIN_SOURCE, 0, 0, size, size);
+    _twin_bevel_paint(pixmap, twin_int_to_fixed(size), twin_int_to_fixed(size),
+                      b, down);
+
+    i = bevel_cache_next;
+    bevel_cache_next = (bevel_cache_next + 1) % TWIN_BEVEL_CACHE_SIZE;
+    if (bevel_cache[i].pixmap)
+        twin_pixmap_destroy(bevel_cache[i].pixmap);
+    bevel_cache[i].b = b;
+    bevel_cache[i].down = down;
+    bevel_cache[i].pixmap = pixmap;
+    return pixmap;
+}
+
+void _twin_widget_bevel(twin_widget_t *widget, twin_fixed_t b, bool down)
+{
+    twin_coord_t w = _twin_widget_width(widget);
+    twin_coord_t h = _twin_widget_height(widget);
+    twin_pixmap_t *pixmap = widget->window->pixmap;
+    twin_pixmap_t *bevel = _twin_bevel_lookup(b, down);
+
+    if (bevel) {
+        twin_coord_t border = bevel->width / 2;
+        twin_rect_t insets = {
+            .left = border, .right = border, .top = border, .bottom = border};
+
+        twin_composite_ninepatch(pixmap, 0, 0, w, h, bevel, insets, TWIN_OVER);
+        return;
+    }
+    _twin_bevel_paint(pixmap, twin_int_to_fixed(w), twin_int_to_fixed(h), b,
+                      down);
+}
+
 void twin_widget_children_paint(twin_box_t *box)
 {
     for (twin_widget_t *child = box->children; child; child = child->next)
@@ -83,22 +83,21 @@ twin_window_t *twin_window_create(twin_screen_t *screen,
     window->client.right = width - right;
     window->client.bottom = height - bottom;
 #if defined(CONFIG_DROP_SHADOW)
-    /* Handle drop shadow.
-     *
-     * Allocate extra space in the pixmap for the drop shadow. The dimensions
-     * match the mask footprint generated by twin_shadow_border(): the shadow
-     * offset plus the blur-shaped fade-out region on the right and bottom
-     * edges.
+    /*
+     * The drop shadow is a shared layer the screen composites beneath the
+     * active window, extending past the right and bottom edges by the mask
+     * footprint of twin_shadow_border(): the shadow offset plus the
+     * blur-shaped fade-out region.  The pixmap itself only keeps room for
+     * the resize grip past those edges.
      */
     window->shadow_x = TWIN_SHADOW_EXTENT_X;
     window->shadow_y = TWIN_SHADOW_EXTENT_Y;
-    window->pixmap = twin_pixmap_create(format, width + window->shadow_x,
-                                        height + window->shadow_y);
 #else
     window->shadow_x = 0;
     window->shadow_y = 0;
-    window->pixmap = twin_pixmap_create(format, width, height);
 #endif
+    window->pixmap = twin_pixmap_create(format, width + TWIN_WINDOW_GRIP,
+                                        height + TWIN_WINDOW_GRIP);
     if (!window->pixmap) {
         twin_free(window);
         return NULL;
@@ -113,6 +112,7 @@ twin_window_t *twin_window_create(twin_screen_t *screen,
     window->draw_queued = false;
     window->client_data = 0;
     window->name = 0;
+    window->frame_pixmap = NULL;
 
     window->draw = 0;
     window->event = 0;
@@ -167,12 +167,11 @@ void twin_window_configure(twin_window_t *window,
 #endif
 
     twin_pixmap_disable_update(window->pixmap);
-    if (width != window->pixmap->width || height != window->pixmap->height) {
+    if (width != window->pixmap->width - TWIN_WINDOW_GRIP ||
+        height != window->pixmap->height - TWIN_WINDOW_GRIP) {
         twin_pixmap_t *old = window->pixmap;
-        twin_coord_t pix_w = width + window->shadow_x;
-        twin_coord_t pix_h = height + window->shadow_y;
-        twin_pixmap_t *new_pixmap =
-            twin_pixmap_create(old->format, pix_w, pix_h);
+        twin_pixmap_t *new_pixmap = twin_pixmap_create(
+            old->format, width + TWIN_WINDOW_GRIP, height + TWIN_WINDOW_GRIP);
         if (!new_pixmap) {
             twin_pixmap_enable_update(window->pixmap);
             return;
@@ -181,6 +180,8 @@ void twin_window_configure(twin_window_t *window,
 
         window->pixmap = new_pixmap;
         window->pixmap->window = window;
+        window->pixmap->opacity = old->opacity;
+        window->pixmap->shadow = old->shadow;
         twin_pixmap_move(window->pixmap, x, y);
         if (old->screen)
             twin_pixmap_show(window->pixmap, window->screen, old);
@@ -200,6 +201,7 @@ void twin_window_configure(twin_window_t *window,
         window->client.top = border.top;
         window->client.right = width - border.right;
         window->client.bottom = height - border.bottom;
+        window->frame_pixmap = NULL;
 
         twin_pixmap_reset_clip(window->pixmap);
         twin_pixmap_clip(window->pixmap, window->client.left,
@@ -220,8 +222,8 @@ bool _twin_window_valid_range(twin_window_t *window,
                               twin_coord_t x,
                               twin_coord_t y)
 {
-    twin_coord_t offset_x = window->shadow_x;
-    twin_coord_t offset_y = window->shadow_y;
+    twin_coord_t offset_x = TWIN_WINDOW_GRIP;
+    twin_coord_t offset_y = TWIN_WINDOW_GRIP;
 
     switch (window->style) {
     case TwinWindowPlain:
@@ -292,6 +294,7 @@ void twin_window_set_name(twin_window_t *window, const char *name)
     strcpy(new_name, name);
     twin_free(window->name);
     window->name = new_name;
+    window->frame_pixmap = NULL;
     twin_window_draw(window);
 }
 
@@ -327,6 +330,21 @@ static void twin_window_frame(twin_window_t *window)
     twin_fixed_t resize_y;
     const char *name;
 
+    /*
+     * The decoration stays in the pixmap outside the client area, which
+     * client drawing never touches, so repaint it only when its inputs
+     * change.
+     */
+    if (window->frame_pixmap == pixmap &&
+        window->frame_width == window->client.right &&
+        window->frame_active == window->active &&
+        window->frame_iconify == window->iconify)
+        return;
+    window->frame_pixmap = pixmap;
+    window->frame_width = window->client.right;
+    window->frame_active = window->active;
+    window->frame_iconify = window->iconify;
+
     twin_pixmap_reset_clip(pixmap);
     twin_pixmap_origin_to_clip(pixmap);
 
@@ -384,8 +402,7 @@ static void twin_window_frame(twin_window_t *window)
     twin_pixmap_origin_to_clip(pixmap);
 
     twin_path_move(path, text_x - twin_fixed_floor(menu_x), text_y);
-    twin_path_utf8(path, name);
-    twin_paint_path(pixmap, TWIN_FRAME_TEXT, path);
+    twin_paint_utf8(pixmap, TWIN_FRAME_TEXT, path, name);
 
     twin_pixmap_reset_clip(pixmap);
     twin_pixmap_origin_to_clip(pixmap);
@@ -434,56 +451,33 @@ static void twin_window_drop_shadow(twin_window_t *window)
 {
     twin_pixmap_t *prev_active_pix = window->screen->top,
                   *active_pix = window->pixmap;
-    twin_source_u src;
-    twin_coord_t y, shadow_left, shadow_top;
-
-    /* Remove the drop shadow from the previously active pixel map. */
-    if (prev_active_pix) {
-        src.c = 0x00000000;
-        for (y = 0; y < prev_active_pix->height; y++) {
-            if (y < prev_active_pix->height - prev_active_pix->window->shadow_y)
-                twin_cover(
-                    prev_active_pix, src.c,
-                    prev_active_pix->width - prev_active_pix->window->shadow_x,
-                    y, prev_active_pix->window->shadow_x);
-            else
-                twin_cover(prev_active_pix, src.c, 0, y,
-                           prev_active_pix->width);
-        }
+
+    /*
+     * The shadow is drawn by the screen beneath whichever pixmap carries the
+     * flag, so moving it only needs the old and new footprints damaged.
+     */
+    if (prev_active_pix && prev_active_pix->shadow &&
+        prev_active_pix->window) {
+        twin_pixmap_damage(
+            prev_active_pix, 0, 0,
+            prev_active_pix->width + prev_active_pix->window->shadow_x,
+            prev_active_pix->height + prev_active_pix->window->shadow_y);
         prev_active_pix->shadow = false;
     }
 
-    /* Mark the previously active pixel map as damaged to update its changes. */
-    if (prev_active_pix && active_pix != prev_active_pix)
-        twin_pixmap_damage(prev_active_pix, 0, 0, prev_active_pix->width,
-                           prev_active_pix->height);
-
     /*
      * The shadow effect of the window only becomes visible when the window is
-     * active.
-     */
-    active_pix->shadow = true;
-    /*
-     * Create a darker border of the active window that gives a more
-     * dimensional appearance.
+     * active. Its darker, blurred border gives a more dimensional appearance.
      */
     /* The shift offset and color of the shadow can be selected by the user. */
-    twin_shadow_border(active_pix, SHADOW_COLOR);
-
-    if (CONFIG_SHADOW_BLUR <= 0)
-        return;
-
-    shadow_left = active_pix->width - active_pix->window->shadow_x;
-    shadow_top = active_pix->height - active_pix->window->shadow_y;
-
-    /* Right side of the active window. */
-    twin_stack_blur(active_pix, CONFIG_SHADOW_BLUR, shadow_left,
-                    shadow_left + active_pix->window->shadow_x, 0,
-                    shadow_top + active_pix->window->shadow_y);
-    /* Bottom side of the active window. */
-    twin_stack_blur(active_pix, CONFIG_SHADOW_BLUR, 0,
-                    shadow_left + active_pix->window->shadow_x, shadow_top,
-                    shadow_top + active_pix->window->shadow_y);
+    const twin_shadow_patch_t *patch =
+        twin_shadow_patch(window->style, SHADOW_COLOR, CONFIG_SHADOW_BLUR);
+    if (window->screen->shadow)
+        twin_shadow_patch_release(window->screen->shadow);
+    window->screen->shadow = patch;
+    active_pix->shadow = true;
+    twin_pixmap_damage(active_pix, 0, 0, active_pix->width + window->shadow_x,
+                       active_pix->height + window->shadow_y);
 }
 #endif /* CONFIG_DROP_SHADOW */
 
@@ -728,8 +722,8 @@ bool _twin_window_dispatch(twin_window_t *window, twin_event_t *event)
             x = event->u.pointer.screen_x - window->screen->button_x;
             y = event->u.pointer.screen_y - window->screen->button_y;
             twin_window_configure(window, window->style, x, y,
-                                  window->pixmap->width,
-                                  window->pixmap->height);
+                                  window->pixmap->width - TWIN_WINDOW_GRIP,
+                                  window->pixmap->height - TWIN_WINDOW_GRIP);
         }
         return true;
     default:
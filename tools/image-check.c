@@ -0,0 +1,161 @@
+/*
+ * Twin - A Tiny Window System
+ * Copyright (c) 2026 National Cheng Kung University, Taiwan
+ * All rights reserved.
+ */
+
+/*
+ * Image decoder conformance checker
+ *
+ * Decodes images under the assets directory and compares the pixels with
+ * checksums recorded from known-good builds, so that reworking a decoder
+ * or renderer cannot silently change its output. Animations are checked
+ * frame by frame in playback order, either decoded as each frame is
+ * reached or with the queued work run between frames, as the dispatch
+ * loop does, so that frames decoded ahead are used; both must match.
+ *
+ * Usage: mado-image-check [-u] [assets-dir]
+ *   -u  print the checksums of this build instead of checking them, for
+ *       updating the table below after an intended change
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "twin.h"
+
+typedef struct {
+    const char *file; /* relative to the assets directory */
+    twin_coord_t size; /* fit within size x size, or 0 for native size;
+                          TinyVG documents are drawn at size x size */
+    uint32_t sum;      /* FNV-1a of the size and pixels of every frame */
+    bool work;         /* run queued work between animation frames */
+} image_check_t;
+
+/* The dispatch loop's work runner, which decodes animation frames ahead */
+extern void _twin_run_work(void);
+
+static const image_check_t checks[] = {
+#if defined(CONFIG_LOADER_GIF)
+    {"nyancat.gif", 0, 0x1bdedbbc, false},
+    {"nyancat.gif", 0, 0x1bdedbbc, true},
+    /* The first frame covers only the middle of a background canvas */
+    {"test/subrect.gif", 0, 0x967e8d8f, false},
+    {"test/subrect.gif", 0, 0x967e8d8f, true},
+#endif
+#if defined(CONFIG_LOADER_TVG)
+    /* Recorded from the floating-point renderer the fixed-point one replaced */
+    {"tiger.tvg", 0, 0x3f34c94f, false},
+    {"tiger.tvg", 400, 0xdef524d0, false},
+    {"tiger.tvg", 1000, 0x25a06857, false},
+    {"shield.tvg", 0, 0x177fe401, false},
+    {"shield.tvg", 400, 0x80dc182d, false},
+    {"shield.tvg", 1000, 0xc62d2807, false},
+    {"folder.tvg", 0, 0x4040b5f2, false},
+    {"folder.tvg", 400, 0x2ea08c18, false},
+    {"folder.tvg", 1000, 0x9d86fce6, false},
+    /* Gradients running leftwards and upwards */
+    {"test/linear.tvg", 0, 0xda9d358d, false},
+    {"test/linear.tvg", 400, 0xcae6e848, false},
+    {"test/radial.tvg", 0, 0xae38e865, false},
+    {"test/radial.tvg", 400, 0x773a85cb, false},
+#endif
+    {NULL, 0, 0, false},
+};
+
+static uint32_t fnv1a(uint32_t h, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+
+    while (len--)
+        h = (h ^ *p++) * 16777619u;
+    return h;
+}
+
+static uint32_t pixmap_sum(uint32_t h, twin_pixmap_t *pixmap)
+{
+    size_t row = (size_t) pixmap->width * (pixmap->format == TWIN_A8      ? 1
+                                           : pixmap->format == TWIN_RGB16 ? 2
+                                                                          : 4);
+
+    h = fnv1a(h, &pixmap->width, sizeof(pixmap->width));
+    h = fnv1a(h, &pixmap->height, sizeof(pixmap->height));
+    for (twin_coord_t y = 0; y < pixmap->height; y++)
+        h = fnv1a(h, pixmap->p.b + (size_t) y * pixmap->stride, row);
+    return h;
+}
+
+static bool image_sum(const char *path,
+                      twin_coord_t size,
+                      bool work,
+                      uint32_t *sum)
+{
+    twin_pixmap_t *pixmap;
+    twin_animation_t *anim;
+
+    if (!size)
+        pixmap = twin_pixmap_from_file(path, TWIN_ARGB32);
+#if defined(CONFIG_LOADER_TVG)
+    /* The fitting loader never enlarges, so draw documents at size x size */
+    else if (strstr(path, ".tvg"))
+        pixmap = twin_tvg_to_pixmap_scale(path, TWIN_ARGB32, size, size);
+#endif
+    else
+        pixmap = twin_pixmap_from_file_scaled(path, TWIN_ARGB32, size, size);
+    if (!pixmap)
+        return false;
+
+    *sum = 2166136261u;
+    anim = pixmap->animation;
+    if (!anim) {
+        *sum = pixmap_sum(*sum, pixmap);
+    } else {
+        for (twin_count_t i = 0; i < anim->n_frames; i++) {
+            *sum = pixmap_sum(*sum, twin_animation_get_current_frame(anim));
+            twin_animation_advance_frame(anim);
+            if (work)
+                _twin_run_work();
+        }
+        twin_animation_destroy(anim);
+    }
+    twin_pixmap_destroy(pixmap);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = "assets";
+    bool update = false;
+    int failed = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-u"))
+            update = true;
+        else
+            dir = argv[i];
+    }
+
+    for (const image_check_t *c = checks; c->file; c++) {
+        char path[512];
+        uint32_t sum;
+
+        snprintf(path, sizeof(path), "%s/%s", dir, c->file);
+        if (!image_sum(path, c->size, c->work, &sum)) {
+            printf("FAIL %s: cannot decode\n", path);
+            failed++;
+        } else if (update) {
+            printf("    {\"%s\", %d, 0x%08x, %s},\n", c->file, c->size,
+                   sum, c->work ? "true" : "false");
+        } else if (sum != c->sum) {
+            printf("FAIL %s @ %d%s: checksum %08x, expected %08x\n", path,
+                   c->size, c->work ? " with work" : "", sum, c->sum);
+            failed++;
+        } else {
+            printf("ok   %s @ %d%s\n", path, c->size,
+                   c->work ? " with work" : "");
+        }
+    }
+    return failed ? 1 : 0;
+}
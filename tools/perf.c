@@ -120,6 +120,74 @@ static void test_solid_over_argb32_opaque(void)
                    test_height);
 }
 
+static void test_argb32_over_argb32_alpha(void)
+{
+    twin_operand_t srco = {.source_kind = TWIN_PIXMAP, .u.pixmap = src32};
+    twin_composite_alpha(dst32, 0, 0, &srco, 0, 0, 0x80, TWIN_OVER, test_width,
+                         test_height);
+}
+
+static void test_argb32_over_argb32_scaled(void)
+{
+    twin_operand_t srco = {.source_kind = TWIN_PIXMAP, .u.pixmap = src32};
+    twin_matrix_identity(&src32->transform);
+    twin_matrix_scale(&src32->transform, twin_double_to_fixed(1.5),
+                      twin_double_to_fixed(1.5));
+    twin_composite(dst32, 0, 0, &srco, 0, 0, NULL, 0, 0, TWIN_OVER, test_width,
+                   test_height);
+    twin_matrix_identity(&src32->transform);
+}
+
+static void test_argb32_source_argb32_filter(twin_fixed_t scale,
+                                             twin_filter_t filter)
+{
+    twin_operand_t srco = {.source_kind = TWIN_PIXMAP, .u.pixmap = src32};
+    twin_matrix_identity(&src32->transform);
+    twin_matrix_scale(&src32->transform, scale, scale);
+    twin_pixmap_set_filter(src32, filter);
+    twin_composite(dst32, 0, 0, &srco, 0, 0, NULL, 0, 0, TWIN_SOURCE,
+                   test_width, test_height);
+    twin_pixmap_set_filter(src32, TWIN_FILTER_BILINEAR);
+    twin_matrix_identity(&src32->transform);
+}
+
+static void test_argb32_source_argb32_nearest(void)
+{
+    test_argb32_source_argb32_filter(twin_double_to_fixed(1.5),
+                                     TWIN_FILTER_NEAREST);
+}
+
+static void test_argb32_source_argb32_box(void)
+{
+    test_argb32_source_argb32_filter(twin_int_to_fixed(4), TWIN_FILTER_BOX);
+}
+
+static void test_argb32_over_argb32_rotated(void)
+{
+    twin_operand_t srco = {.source_kind = TWIN_PIXMAP, .u.pixmap = src32};
+    twin_matrix_identity(&src32->transform);
+    twin_matrix_rotate(&src32->transform, TWIN_ANGLE_22_5);
+    twin_composite(dst32, 0, 0, &srco, 0, 0, NULL, 0, 0, TWIN_OVER, test_width,
+                   test_height);
+    twin_matrix_identity(&src32->transform);
+}
+
+static void test_argb32_blur(void)
+{
+    twin_stack_blur(dst32, 15, 0, test_width, 0, test_height);
+}
+
+static void test_text_utf8(void)
+{
+    twin_path_t *path = twin_path_create();
+
+    twin_path_set_font_size(path, twin_int_to_fixed(14));
+    twin_path_move(path, twin_int_to_fixed(4), twin_int_to_fixed(20));
+    twin_paint_utf8(dst32, 0xff000000, path,
+                    "The quick brown fox jumps over the lazy dog");
+    twin_path_destroy(path);
+}
+
 /* Measure sync time by calling gettimeofday() repeatedly */
 static void measure_sync_time(void)
 {
@@ -291,6 +359,8 @@ static void run_alpha_tests(void)
                     100);
     run_test_series("100x100 solid over opaque", test_solid_over_argb32_opaque,
                     100, 100);
+    run_test_series("100x100 argb32 over 50% alpha",
+                    test_argb32_over_argb32_alpha, 100, 100);
 }
 
 static void run_large_tests(void)
@@ -299,7 +369,18 @@ static void run_large_tests(void)
     run_test_series("500x500 argb32 source", test_argb32_source_argb32, 500,
                     500);
     run_test_series("500x500 argb32 over", test_argb32_over_argb32, 500, 500);
+    run_test_series("500x500 argb32 over scaled",
+                    test_argb32_over_argb32_scaled, 500, 500);
+    run_test_series("500x500 argb32 over rotated",
+                    test_argb32_over_argb32_rotated, 500, 500);
+    run_test_series("500x500 argb32 source nearest",
+                    test_argb32_source_argb32_nearest, 500, 500);
+    run_test_series("200x200 argb32 source box 4x",
+                    test_argb32_source_argb32_box, 200, 200);
+    run_test_series("500x500 argb32 blur radius 15", test_argb32_blur, 500,
+                    500);
     run_test_series("500x500 solid over", test_solid_over_argb32, 500, 500);
+    run_test_series("43 glyph text run", test_text_utf8, 500, 40);
 }
 
 /* Memory profiling mode */
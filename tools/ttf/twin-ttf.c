@@ -29,15 +29,41 @@ static double pos(FT_Pos x, outline_closure_t *c)
     return (double) x / (double) face->units_per_EM;
 }
 
+static void emit(signed char v, outline_closure_t *c)
+{
+    if (c->size % 4096 == 0)
+        c->data = realloc(c->data, c->size + 4096);
+    c->data[c->size++] = v;
+}
+
+static void newline(outline_closure_t *c)
+{
+    if (!c->binary)
+        printf("\n");
+}
+
 static void command(char cmd, outline_closure_t *c)
 {
-    printf("\t'%c', ", cmd);
+    if (c->binary)
+        emit(cmd, c);
+    else
+        printf("\t'%c', ", cmd);
     c->offset++;
 }
 
+static int cval(FT_Pos x, outline_closure_t *c)
+{
+    return ((int) (floor(64.0 * pos(x, c) + 0.5))) & 0xff;
+}
+
 static void cpos(FT_Pos x, outline_closure_t *c)
 {
-    printf("0x%02x, ", ((int) (floor(64.0 * pos(x, c) + 0.5))) & 0xff);
+    int v = cval(x, c);
+
+    if (c->binary)
+        emit(v, c);
+    else
+        printf("0x%02x, ", v);
     c->offset++;
 }
 
@@ -77,9 +103,11 @@ static unsigned char *ucs4_to_utf8(FT_ULong ucs4, unsigned char dest[8])
 static void glyph(FT_Pos advance, FT_ULong ucs4, outline_closure_t *c)
 {
     unsigned char utf8[8];
-    printf("    /* 0x%lx (%s) */ ", ucs4, ucs4_to_utf8(ucs4, utf8));
+
+    if (!c->binary)
+        printf("    /* 0x%lx (%s) */ ", ucs4, ucs4_to_utf8(ucs4, utf8));
     cpos(advance, c);
-    printf("\n");
+    newline(c);
 }
 
 static int outline_moveto(const FT_Vector *to, void *user)
@@ -88,7 +116,7 @@ static int outline_moveto(const FT_Vector *to, void *user)
     command('m', c);
     cpos(to->x, c);
     cpos(to->y, c);
-    printf("\n");
+    newline(c);
     return 0;
 }
 
@@ -98,7 +126,7 @@ static int outline_lineto(const FT_Vector *to, void *user)
     command('l', c);
     cpos(to->x, c);
     cpos(to->y, c);
-    printf("\n");
+    newline(c);
     return 0;
 }
 
@@ -112,7 +140,7 @@ static int outline_conicto(const FT_Vector *control,
     cpos(control->y, c);
     cpos(to->x, c);
     cpos(to->y, c);
-    printf("\n");
+    newline(c);
     return 0;
 }
 
@@ -129,7 +157,7 @@ static int outline_cubicto(const FT_Vector *control1,
     cpos(control2->y, c);
     cpos(to->x, c);
     cpos(to->y, c);
-    printf("\n");
+    newline(c);
     return 0;
 }
 
@@ -182,17 +210,123 @@ static char *facename(FT_Face face)
 
 #define MAX_UCS4 0x1000000
 
-static int convert_font(char *in_name, int id)
+/*
+ * Binary font file, mapped read-only by twin_font_load(). Must match the
+ * layout documented in src/font-file.c: a header, the family and style
+ * names, the charmap records (page number followed by UCS_PER_PAGE glyph
+ * offsets), the two-level page index and the glyph outlines. Everything is
+ * in host byte order and every section starts on a 4-byte boundary.
+ */
+#define FONT_FILE_VERSION 1
+#define FONT_FILE_BYTE_ORDER 0x0102
+#define FONT_TYPE_TTF 2
+#define PAGE_MAX (0x110000 >> UCS_PAGE_SHIFT)
+#define PAGE_BLOCK_SHIFT 6
+#define PAGE_BLOCK (1 << PAGE_BLOCK_SHIFT)
+#define PAGE_BLOCKS (PAGE_MAX >> PAGE_BLOCK_SHIFT)
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t byte_order;
+    uint8_t type;
+    int8_t ascender;
+    int8_t descender;
+    int8_t height;
+    uint32_t name;
+    uint32_t style;
+    uint32_t n_charmap;
+    uint32_t charmap;
+    uint32_t index;
+    uint32_t index_size;
+    uint32_t outlines;
+    uint32_t outlines_size;
+} font_file_header_t;
+
+static uint32_t write_section(FILE *f, const void *data, size_t size)
+{
+    static const char pad[4];
+    long at = ftell(f);
+
+    fwrite(pad, 1, (4 - at % 4) % 4, f);
+    at = ftell(f);
+    fwrite(data, 1, size, f);
+    return at;
+}
+
+static int write_font_file(const char *out_name,
+                           FT_Face face,
+                           outline_closure_t *c,
+                           const uint32_t *charmap,
+                           int ncharmap)
+{
+    font_file_header_t h = {
+        .magic = {'T', 'W', 'F', 'N'},
+        .version = FONT_FILE_VERSION,
+        .byte_order = FONT_FILE_BYTE_ORDER,
+        .type = FONT_TYPE_TTF,
+        .n_charmap = ncharmap,
+    };
+    uint16_t top[PAGE_BLOCKS] = {0};
+    uint16_t *index;
+    int nblocks = 1;
+    size_t index_size;
+    FILE *f;
+
+    for (int i = 0; i < ncharmap; i++) {
+        uint32_t page = charmap[i * (1 + UCS_PER_PAGE)];
+
+        if (page < PAGE_MAX && !top[page >> PAGE_BLOCK_SHIFT])
+            top[page >> PAGE_BLOCK_SHIFT] = nblocks++;
+    }
+    index_size = sizeof(top) + nblocks * PAGE_BLOCK * sizeof(uint16_t);
+    index = calloc(1, index_size);
+    memcpy(index, top, sizeof(top));
+    for (int i = ncharmap - 1; i >= 0; i--) {
+        uint32_t page = charmap[i * (1 + UCS_PER_PAGE)];
+
+        if (page < PAGE_MAX)
+            index[PAGE_BLOCKS + top[page >> PAGE_BLOCK_SHIFT] * PAGE_BLOCK +
+                  (page & (PAGE_BLOCK - 1))] = i + 1;
+    }
+
+    h.ascender = cval(face->ascender, c);
+    h.descender = cval(face->descender, c);
+    h.height = cval(face->height, c);
+
+    f = fopen(out_name, "wb");
+    if (!f) {
+        free(index);
+        return 0;
+    }
+    fwrite(&h, sizeof(h), 1, f);
+    h.name = write_section(f, face->family_name, strlen(face->family_name) + 1);
+    h.style = write_section(f, face->style_name, strlen(face->style_name) + 1);
+    h.charmap = write_section(f, charmap, ncharmap * (1 + UCS_PER_PAGE) *
+                                              sizeof(uint32_t));
+    h.index = write_section(f, index, index_size);
+    h.index_size = index_size;
+    h.outlines = write_section(f, c->data, c->size);
+    h.outlines_size = c->size;
+    fseek(f, 0, SEEK_SET);
+    fwrite(&h, sizeof(h), 1, f);
+    free(index);
+    return fclose(f) == 0;
+}
+
+static int convert_font(char *in_name, int id, const char *out_name)
 {
     FT_Library ftLibrary;
     FT_Face face;
     FT_UInt gindex;
     FT_ULong ucs4;
     FT_Int32 load_flags;
-    outline_closure_t closure;
+    outline_closure_t closure = {0};
     FT_ULong min_ucs4, max_ucs4;
     int *offsets;
     int ncharmap;
+    uint32_t *charmap = NULL;
+    int ret;
 
     if (FT_Init_FreeType(&ftLibrary))
         return 0;
@@ -207,15 +341,18 @@ static int convert_font(char *in_name, int id)
 
     closure.face = face;
     closure.offset = 0;
+    closure.binary = out_name != NULL;
 
     offsets = calloc(face->num_glyphs + 1, sizeof(int));
 
     min_ucs4 = 0xffffff;
     max_ucs4 = 0;
-    printf("/* Derived from %s */\n\n", in_name);
-    printf("#include \"twin_private.h\"\n\n");
-    printf("/* clang-format off */\n");
-    printf("static const char outlines[] = {\n");
+    if (!closure.binary) {
+        printf("/* Derived from %s */\n\n", in_name);
+        printf("#include \"twin_private.h\"\n\n");
+        printf("/* clang-format off */\n");
+        printf("static const char outlines[] = {\n");
+    }
     for (ucs4 = FT_Get_First_Char(face, &gindex);
          gindex != 0 && ucs4 < MAX_UCS4;
          ucs4 = FT_Get_Next_Char(face, ucs4, &gindex)) {
@@ -229,11 +366,13 @@ static int convert_font(char *in_name, int id)
         glyph(face->glyph->linearHoriAdvance, ucs4, &closure);
         FT_Outline_Decompose(&face->glyph->outline, &outline_funcs, &closure);
         command('e', &closure);
-        printf("\n");
+        newline(&closure);
+    }
+    if (!closure.binary) {
+        printf("};\n");
+        printf("/* clang-format on */\n\n");
+        printf("static const twin_charmap_t charmap[] = {\n");
     }
-    printf("};\n");
-    printf("/* clang-format on */\n\n");
-    printf("static const twin_charmap_t charmap[] = {\n");
     ncharmap = 0;
     for (ucs4 = FT_Get_First_Char(face, &gindex);
          gindex != 0 && ucs4 < MAX_UCS4;
@@ -241,19 +380,37 @@ static int convert_font(char *in_name, int id)
         FT_ULong page = ucs_first_in_page(ucs4);
         FT_ULong off;
 
-        printf("    { 0x%04x, {\n", ucs_page(page));
-        for (off = 0; off < UCS_PER_PAGE; off++) {
-            FT_UInt g = FT_Get_Char_Index(face, page + off);
-            if ((off & 7) == 0)
-                printf("\t");
-            printf("0x%04x, ", offsets[g]);
-            if ((off & 7) == 7)
-                printf("\n");
+        if (closure.binary) {
+            uint32_t *rec;
+
+            charmap = realloc(charmap, (ncharmap + 1) * (1 + UCS_PER_PAGE) *
+                                           sizeof(uint32_t));
+            rec = charmap + ncharmap * (1 + UCS_PER_PAGE);
+            rec[0] = ucs_page(page);
+            for (off = 0; off < UCS_PER_PAGE; off++)
+                rec[1 + off] = offsets[FT_Get_Char_Index(face, page + off)];
+        } else {
+            printf("    { 0x%04x, {\n", ucs_page(page));
+            for (off = 0; off < UCS_PER_PAGE; off++) {
+                FT_UInt g = FT_Get_Char_Index(face, page + off);
+                if ((off & 7) == 0)
+                    printf("\t");
+                printf("0x%04x, ", offsets[g]);
+                if ((off & 7) == 7)
+                    printf("\n");
+            }
+            printf("    }},\n");
         }
-        printf("    }},\n");
         ucs4 = page + UCS_PER_PAGE - 1;
         ncharmap++;
     }
+    if (closure.binary) {
+        ret = write_font_file(out_name, face, &closure, charmap, ncharmap);
+        free(charmap);
+        free(closure.data);
+        free(offsets);
+        return ret;
+    }
     printf("};\n\n");
     printf("twin_font_t twin_%s = {\n", facename(face));
     printf("    .name = \"%s\",\n", face->family_name);
@@ -271,14 +428,22 @@ static int convert_font(char *in_name, int id)
     cpos(face->height, &closure);
     printf("\n");
     printf("};\n");
+    free(offsets);
     return 1;
 }
 
 int main(int argc, char **argv)
 {
+    const char *out_name = NULL;
+
+    /* twin-ttf [-o font.twf] font.ttf: binary font file, or C to stdout */
+    if (argc >= 3 && !strcmp(argv[1], "-o")) {
+        out_name = argv[2];
+        argv += 2;
+        argc -= 2;
+    }
     if (argc < 2)
         return 1;
 
-    convert_font(argv[1], 0);
-    return 0;
+    return convert_font(argv[1], 0, out_name) ? 0 : 1;
 }
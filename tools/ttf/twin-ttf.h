@@ -29,11 +29,17 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 typedef struct {
     FT_Face face;
     int offset;
+    /* Binary output collects the outline bytes instead of printing them */
+    int binary;
+    signed char *data;
+    int size;
 } outline_closure_t;
 
 #endif /* _TWIN_TTF_H_ */